@@ -16,10 +16,19 @@
 
 
 bool Abstract_Mark_Sweep_Collector::print_gc = true;
+bool Abstract_Mark_Sweep_Collector::parallel_mark = true;
+bool Abstract_Mark_Sweep_Collector::concurrent_mark = false;
+int  Abstract_Mark_Sweep_Collector::concurrent_mark_start_percent = 50;
+int  Abstract_Mark_Sweep_Collector::concurrent_mark_step_size = 10000;
+bool Abstract_Mark_Sweep_Collector::incremental_gc = false;
+int  Abstract_Mark_Sweep_Collector::incremental_gc_start_percent = 10;
+int  Abstract_Mark_Sweep_Collector::incremental_gc_step_size = 10000;
 
 
 Abstract_Mark_Sweep_Collector::Abstract_Mark_Sweep_Collector() {
   mark_stack = NULL;
+  work_pool = NULL;
+  is_busy_concurrent_marker = false;
   weakRootCount = 0;
   weakRoot_accessor = NULL;
 }
@@ -44,6 +53,8 @@ void Abstract_Mark_Sweep_Collector::gc() {
 
   assert(The_Squeak_Interpreter()->safepoint_tracker->have_acquired_safepoint());
   flushFreeContextsMessage_class().send_to_all_cores();
+  The_Memory_System()->finish_lazy_sweeping_everywhere(); // marks have to start out clear
+  The_Memory_System()->forward_moved_objects(); // else an old copy would be marked instead of the new one
   prepare(true);
   do_it();
   finish();
@@ -84,6 +95,12 @@ void Abstract_Mark_Sweep_Collector::finalize_weak_arrays() {
   for (u_int32 i = 0;  i < weakRootCount; ++i)
     finalizeReference(weakRoots[i].as_object());
   weakRootCount = 0;
+
+  if (work_pool != NULL) {
+    for (int i = 0;  i < work_pool->get_weak_root_count();  ++i)
+      finalizeReference(work_pool->weak_root_at(i).as_object());
+    work_pool = NULL;
+  }
 }
 
 
@@ -109,19 +126,293 @@ public:
 
 
 void Abstract_Mark_Sweep_Collector::mark() {
+  // The grey objects left over from a concurrent mark are spread over all cores, so use them all for the remark.
+  bool finishing_concurrent_mark = The_Memory_System()->is_marking_concurrently();
+  if (finishing_concurrent_mark) {
+    The_Memory_System()->set_marking_concurrently(false);
+    if (print_gc)
+      lprintf("final remark of concurrent mark\n");
+  }
+  if (finishing_concurrent_mark  ||  (parallel_mark  &&  Logical_Core::group_size > 1))
+    mark_in_parallel(finishing_concurrent_mark);
+  else
+    mark_serially();
+}
+
+
+void Abstract_Mark_Sweep_Collector::mark_serially() {
   The_Memory_System()->enforce_coherence_before_this_core_stores_into_all_heaps();
   Mark_Closure mc(this);
   The_Interactions.do_all_roots_here(&mc);
 
-  while (!mark_stack->is_empty())
-    mark_an_object(mark_stack->pop());
+  drain_mark_stack();
+
+  The_Memory_System()->enforce_coherence_after_this_core_has_stored_into_all_heaps();
+
+  if (!mark_stack->is_empty()) fatal("");
+  delete mark_stack;
+  mark_stack = NULL;
+
+}
+
+
+void Abstract_Mark_Sweep_Collector::drain_mark_stack() {
+  if (work_pool == NULL) {
+    while (!mark_stack->is_empty())
+      mark_an_object(mark_stack->pop());
+    return;
+  }
+  do {
+    while (!mark_stack->is_empty()) {
+      work_pool->publish_surplus(mark_stack);
+      Object* o = mark_stack->pop();
+      if (!o->isFreeObject()) // was moved while marking concurrently, see regrey_moved_object
+        mark_an_object(o);
+    }
+  } while (work_pool->steal_or_terminate(mark_stack));
+}
+
+
+// Kept in the global GC values, so that all cores find the same one, even on processes.
+Parallel_Mark_Work_Pool* Abstract_Mark_Sweep_Collector::get_work_pool() {
+  Parallel_Mark_Work_Pool* pool = The_Memory_System()->get_mark_work_pool();
+  if (pool == NULL) {
+    pool = new Parallel_Mark_Work_Pool();
+    The_Memory_System()->set_mark_work_pool(pool);
+  }
+  return pool;
+}
+
+
+// Instead of having every other core report its roots back to me one message at a time,
+// each core marks from its own roots, and cores that run dry steal grey objects from the others.
+// The other cores are spinning in the GC safepoint, and will handle the parallelMarkMessage there.
+void Abstract_Mark_Sweep_Collector::mark_in_parallel(bool finishing_concurrent_mark) {
+  Parallel_Mark_Work_Pool* pool = get_work_pool();
+
+  The_Memory_System()->enforce_coherence_before_this_core_stores_into_all_heaps();
+
+  pool->reset(Logical_Core::group_size, finishing_concurrent_mark);
+  work_pool = pool;
+
+  parallelMarkMessage_class(pool).send_to_other_cores();
+
+  take_over_concurrent_mark_stack();
+  Mark_Closure mc(this);
+  The_Squeak_Interpreter()->do_all_roots(&mc);
+  drain_mark_stack();
+
+  while (!pool->are_all_helpers_finished())
+    Message_Statics::process_any_incoming_messages(false);
 
   The_Memory_System()->enforce_coherence_after_this_core_has_stored_into_all_heaps();
 
   if (!mark_stack->is_empty()) fatal("");
   delete mark_stack;
   mark_stack = NULL;
+  // work_pool stays set until weak roots are finalized
+}
+
+
+void Abstract_Mark_Sweep_Collector::mark_as_parallel_helper(Parallel_Mark_Work_Pool* pool) {
+  mark_stack = new GC_Oop_Stack();
+  work_pool = pool;
+  take_over_concurrent_mark_stack();
+  {
+    Safepoint_Ability sa(false);
+    Mark_Closure mc(this);
+    The_Squeak_Interpreter()->do_all_roots(&mc);
+  }
+  drain_mark_stack();
+
+  The_Memory_System()->enforce_coherence_after_this_core_has_stored_into_all_heaps();
+
+  delete mark_stack;
+  mark_stack = NULL;
+  work_pool = NULL;
+  pool->helper_is_finished();
+}
+
+
+
+Abstract_Mark_Sweep_Collector* Abstract_Mark_Sweep_Collector::concurrent_markers[Max_Number_Of_Cores] = { NULL };
+
+
+// Called periodically by each interpreter; begins a concurrent mark once a core has used up
+// concurrent_mark_start_percent of the space it had free after the last GC.
+void Abstract_Mark_Sweep_Collector::start_concurrent_mark_if_needed() {
+  if (!concurrent_mark  ||  The_Memory_System()->is_marking_concurrently())
+    return;
+  if (has_used_up_percent_of_space_left_after_gc(concurrent_mark_start_percent))
+    start_concurrent_mark();
+}
+
+
+bool Abstract_Mark_Sweep_Collector::has_used_up_percent_of_space_left_after_gc(int percent) {
+  Multicore_Object_Heap* h = The_Memory_System()->heaps[Logical_Core::my_rank()][Memory_System::read_write];
+  u_int64 free_after_gc = h->get_bytes_left_after_last_gc();
+  return u_int64(h->bytes_free()) * 100  <=  free_after_gc * (100 - percent);
+}
 
+
+void Abstract_Mark_Sweep_Collector::start_concurrent_mark() {
+  Safepoint_for_moving_objects sf("start concurrent mark");
+  Safepoint_Ability sa(false);
+
+  if (The_Memory_System()->is_marking_concurrently())
+    return; // another core beat me to it
+
+  if (print_gc)
+    lprintf("starting concurrent mark on %d\n", Logical_Core::my_rank());
+
+  // Recycled contexts are reused without barriers, so start with empty free lists.
+  flushFreeContextsMessage_class().send_to_all_cores();
+  The_Memory_System()->finish_lazy_sweeping_everywhere(); // the marks are shared
+
+  Parallel_Mark_Work_Pool* pool = get_work_pool();
+  pool->reset(0, false);
+  The_Memory_System()->enforce_coherence_before_this_core_stores_into_all_heaps();
+  The_Memory_System()->set_marking_concurrently(true);
+
+  startConcurrentMarkMessage_class(pool).send_to_all_cores();
+}
+
+
+// Grey my roots and scan my active contexts while every core is stopped.
+void Abstract_Mark_Sweep_Collector::start_concurrent_mark_here(Parallel_Mark_Work_Pool* pool) {
+  int r = Logical_Core::my_rank();
+  if (concurrent_markers[r] == NULL)
+    concurrent_markers[r] = new Mark_Sweep_Collector();
+  Abstract_Mark_Sweep_Collector* m = concurrent_markers[r];
+  m->mark_stack = new GC_Oop_Stack();
+  m->work_pool = pool;
+  m->is_busy_concurrent_marker = false;
+
+  Squeak_Interpreter* interp = The_Squeak_Interpreter();
+  interp->preGCAction_here(false); // store the context registers, so the active context can be scanned
+  {
+    Safepoint_Ability sa(false);
+    Mark_Closure mc(m);
+    interp->do_all_roots(&mc);
+  }
+  if (interp->process_is_scheduled_and_executing())
+    scan_context_being_activated(interp->activeContext_obj(), interp->theHomeContext_obj());
+
+  // let idle cores help out
+  pool->publish(m->mark_stack, m->mark_stack->size());
+  The_Memory_System()->enforce_coherence_after_this_core_has_stored_into_all_heaps();
+}
+
+
+void Abstract_Mark_Sweep_Collector::do_concurrent_mark_step() {
+  if (!The_Memory_System()->is_marking_concurrently()) {
+    start_concurrent_mark_if_needed();
+    return;
+  }
+  do_some_marking_or_finish(concurrent_mark_step_size);
+}
+
+
+// Starting a cycle only costs the short root-greying safepoint, but there is no point
+// in it until some of the space freed by the last GC has been used again.
+void Abstract_Mark_Sweep_Collector::do_incremental_gc_step() {
+  if (!incremental_gc)
+    return;
+  if (!The_Memory_System()->is_marking_concurrently()) {
+    if (has_used_up_percent_of_space_left_after_gc(incremental_gc_start_percent))
+      start_concurrent_mark();
+    return;
+  }
+  do_some_marking_or_finish(incremental_gc_step_size);
+}
+
+
+void Abstract_Mark_Sweep_Collector::do_some_marking_or_finish(int n) {
+  Abstract_Mark_Sweep_Collector* m = concurrent_markers[Logical_Core::my_rank()];
+  if (m == NULL  ||  m->mark_stack == NULL)
+    return;
+  if (m->do_some_concurrent_marking(n))
+    return;
+
+  Parallel_Mark_Work_Pool* pool = m->work_pool;
+  if (m->is_busy_concurrent_marker) {
+    m->is_busy_concurrent_marker = false;
+    if (pool->concurrent_marker_became_idle_and_no_work_is_left())
+      finish_concurrent_mark();
+  }
+}
+
+
+void Abstract_Mark_Sweep_Collector::finish_concurrent_mark() {
+  Safepoint_for_moving_objects sf("finish concurrent mark");
+  if (The_Memory_System()->is_marking_concurrently()) // else another core already did the remark
+    The_Memory_System()->fullGC("concurrent mark finished");
+}
+
+
+// Returns false if I ran out of work.
+bool Abstract_Mark_Sweep_Collector::do_some_concurrent_marking(int n) {
+  for (int i = 0;  i < n;  ++i) {
+    if (mark_stack->is_empty()  &&  !work_pool->steal(mark_stack))
+      return false;
+    if (!is_busy_concurrent_marker) {
+      is_busy_concurrent_marker = true;
+      work_pool->concurrent_marker_became_busy();
+    }
+    work_pool->publish_surplus(mark_stack);
+    Object* o = mark_stack->pop();
+    if (!o->isFreeObject())
+      mark_an_object(o);
+  }
+  return true;
+}
+
+
+// The GC uses my concurrent marker's leftovers as more roots.
+void Abstract_Mark_Sweep_Collector::take_over_concurrent_mark_stack() {
+  Abstract_Mark_Sweep_Collector* m = concurrent_markers[Logical_Core::my_rank()];
+  if (m == NULL  ||  m->mark_stack == NULL)
+    return;
+  while (!m->mark_stack->is_empty())
+    mark_stack->push(m->mark_stack->pop());
+  delete m->mark_stack;
+  m->mark_stack = NULL;
+  m->work_pool = NULL;
+  m->is_busy_concurrent_marker = false;
+}
+
+
+// The snapshot-at-the-beginning barrier: whatever was reachable when marking started must get marked,
+// so grey the oop that is about to be overwritten.
+void Abstract_Mark_Sweep_Collector::record_overwritten_oop(Oop x) {
+  Abstract_Mark_Sweep_Collector* m = concurrent_markers[Logical_Core::my_rank()];
+  if (m != NULL  &&  m->mark_stack != NULL)
+    m->mark(&x);
+}
+
+
+// The interpreter stores into the active and home contexts without barriers,
+// so their contents as of activation must be greyed right away.
+void Abstract_Mark_Sweep_Collector::scan_context_being_activated(Object_p ctx, Object_p home_ctx) {
+  Abstract_Mark_Sweep_Collector* m = concurrent_markers[Logical_Core::my_rank()];
+  if (m == NULL  ||  m->mark_stack == NULL)
+    return;
+  Oop c = ctx->as_oop();
+  m->mark(&c);
+  m->mark_an_object(ctx);
+  if (home_ctx != ctx) {
+    Oop h = home_ctx->as_oop();
+    m->mark(&h);
+    m->mark_an_object(home_ctx);
+  }
+}
+
+
+// Markers hold object addresses, so an object moved by move_to_heap must be scanned again at its new address.
+void Abstract_Mark_Sweep_Collector::regrey_moved_object(Object_p obj) {
+  Abstract_Mark_Sweep_Collector* m = concurrent_markers[Logical_Core::my_rank()];
+  if (m != NULL  &&  m->mark_stack != NULL  &&  obj->is_marked())
+    m->mark_stack->push(obj);
 }
 
 
@@ -136,6 +427,9 @@ void Abstract_Mark_Sweep_Collector::unmark_maybe_compact_set_translation_buffer_
 
 
 bool Abstract_Mark_Sweep_Collector::add_weakRoot(Oop x) {
+  if (work_pool != NULL)
+    return work_pool->add_weak_root(x);
+
   if (weakRoot_accessor == NULL)  weakRoot_accessor = Logical_Core::my_core();
   else if (weakRoot_accessor != Logical_Core::my_core()) fatal("must be accessed from same core");
 
@@ -15,6 +15,13 @@
 class Abstract_Mark_Sweep_Collector {
 public:
   static bool print_gc; // threadsafe: set-once config flag
+  static bool parallel_mark; // threadsafe: set-once config flag
+  static bool concurrent_mark; // threadsafe: set-once config flag
+  static int  concurrent_mark_start_percent; // threadsafe: set-once config value
+  static int  concurrent_mark_step_size;     // threadsafe: set-once config value
+  static bool incremental_gc; // threadsafe: set-once config flag
+  static int  incremental_gc_start_percent;  // threadsafe: set-once config value
+  static int  incremental_gc_step_size;      // threadsafe: set-once config value
 
   Abstract_Mark_Sweep_Collector();
 
@@ -29,7 +36,43 @@ protected:
   virtual void finish();
 
   void mark();
+  void mark_serially();
+  void mark_in_parallel(bool finishing_concurrent_mark);
+  void drain_mark_stack();
   GC_Oop_Stack* mark_stack;
+  Parallel_Mark_Work_Pool* work_pool; // NULL unless marking in parallel
+  static Parallel_Mark_Work_Pool* get_work_pool();
+
+ public:
+  void mark_as_parallel_helper(Parallel_Mark_Work_Pool*);
+
+  // Mostly-concurrent marking: a short safepoint greys the roots, then every core does a bit of marking
+  // each time it checks for interrupts while the interpreters keep running.
+  // Stores record the overwritten oop (snapshot at the beginning), contexts are scanned when activated
+  // since the interpreter stores into them without barriers, and new objects are allocated marked.
+  // The next gc() does the final remark.
+  static void start_concurrent_mark_if_needed();
+  static void start_concurrent_mark_here(Parallel_Mark_Work_Pool*);
+  static void do_concurrent_mark_step();
+  // Incremental GC rides on the same machinery, but is paced by the image's calls to incrementalGC,
+  // each of which marks at most incremental_gc_step_size objects; the call that runs out of grey objects does the remark.
+  // The mode implies lazy sweeping onto free lists, so the remark only compacts heaps that have become too fragmented.
+  static void do_incremental_gc_step();
+  static void record_overwritten_oop(Oop);
+  static void scan_context_being_activated(Object_p ctx, Object_p home_ctx);
+  static void regrey_moved_object(Object_p);
+
+ protected:
+  static Abstract_Mark_Sweep_Collector* concurrent_markers[Max_Number_Of_Cores]; // threadsafe: each core only uses its own
+  bool is_busy_concurrent_marker;
+  static bool has_used_up_percent_of_space_left_after_gc(int);
+  static void start_concurrent_mark();
+  static void do_some_marking_or_finish(int);
+  static void finish_concurrent_mark();
+  bool do_some_concurrent_marking(int);
+  void take_over_concurrent_mark_stack();
+
+ protected:
 
   u_int32   weakRootCount;
   Oop       weakRoots[10000];
@@ -46,8 +89,14 @@ protected:
       fatal();
     if (o->is_marked())
       return;
+    if (work_pool != NULL) {
+      // other cores may be racing to mark the same object
+      if (!o->mark_atomically_without_store_barrier())
+        return;
+    }
+    else
+      o->mark_without_store_barrier();
     mark_stack->push(o);
-    o->mark_without_store_barrier();
   }
 
   void mark_an_object(Object* o) {
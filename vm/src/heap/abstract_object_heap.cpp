@@ -24,9 +24,10 @@ void Abstract_Object_Heap::initialize() {
 
 void Abstract_Object_Heap::initialize(void* mem, int size) {
   _start = _next = (Oop*)mem;
-  _end = _next + size/sizeof(Oop);
+  _end = _end_of_reservation = _next + size/sizeof(Oop);
   zap_unused_portion();
   lowSpaceThreshold = 1000;
+  bytes_left_after_last_gc = bytesLeft();
 }
 
 
@@ -34,7 +35,7 @@ void Abstract_Object_Heap::initialize(void* mem, int size) {
 
 Object* Abstract_Object_Heap::firstAccessibleObject() {
   FOR_EACH_OBJECT_IN_HEAP(this, obj)
-    if (!obj->isFreeObject())  return obj;
+    if (is_accessible(obj))  return obj;
   return NULL;
 }
 
@@ -42,7 +43,7 @@ Object* Abstract_Object_Heap::firstAccessibleObject() {
 Oop Abstract_Object_Heap::initialInstanceOf(Oop classPointer) {
   // "Support for instance enumeration. Return the first instance of the given class, or nilObj if it has no instances."
   FOR_EACH_OBJECT_IN_HEAP(this, obj)
-    if (!obj->isFreeObject()  &&  obj->fetchClass() == classPointer )
+    if (is_accessible(obj)  &&  obj->fetchClass() == classPointer )
       return obj->as_oop();
   return The_Squeak_Interpreter()->roots.nilObj;
 }
@@ -68,12 +69,12 @@ bool Abstract_Object_Heap::verify() {
   Object *prev_obj = NULL;
   __attribute__((unused)) Object *prev_prev_obj = NULL; // debugging
   FOR_EACH_OBJECT_IN_HEAP(this, obj) {
-    if (obj->is_marked()) {
-      lprintf("object 0x%x should not be marked but is; header is 0x%x, in heaps[%d][%d]\n",
+    if (obj->is_marked()  &&  !The_Memory_System()->is_marking_concurrently()  &&  !is_unswept(obj)) {
+      lprintf("object %p should not be marked but is; header is 0x%x, in heaps[%d][%d]\n",
       obj, obj->baseHeader, obj->rank(), obj->mutability());
       fatal("");
     }
-    if (!obj->isFreeObject() &&  obj->is_current_copy())
+    if (is_accessible(obj) &&  obj->is_current_copy())
       ok = obj->verify() && ok;
     
     if (!ok) dittoing_stdout_printer->printf("Failed to verify obj at %p\n", obj);
@@ -81,6 +82,8 @@ bool Abstract_Object_Heap::verify() {
     prev_prev_obj = prev_obj;
     prev_obj = obj;
   }
+  if (Memory_System::use_free_lists)
+    ok = free_chunks.verify(this) && ok;
   dittoing_stdout_printer->printf("Object_Heap %sverified\n", ok ? "" : "NOT ");
   return ok;
 }
@@ -126,12 +129,36 @@ void Abstract_Object_Heap::do_all_oops(Oop_Closure* oc) {
 void Abstract_Object_Heap::scan_compact_or_make_free_objects(bool compacting, Abstract_Mark_Sweep_Collector* gc_or_null) {
   bool for_gc = gc_or_null != NULL;
   // enforce mutability at higher level
+  compacting = will_compact(compacting, for_gc); // or sweep in place, now or lazily
   if (for_gc || compacting)
     The_Memory_System()->object_table->pre_store_whole_enchillada();
 
   if (compacting) ++compactionsSinceLastQuery;
+  if (for_gc || compacting)
+    free_chunks.clear(); // the sweep finds them again
+
+  if (for_gc  &&  !compacting  &&  Memory_System::lazy_sweep) {
+    sweep_next = _start;  sweep_end = _next; // leave it to sweep_some
+  }
+  else if (for_gc  &&  Memory_System::use_mark_bitmap)
+    compact_or_make_free_objects_using_mark_bitmap(compacting);
+  else
+    walk_compact_or_make_free_objects(compacting, for_gc);
+
+  if (for_gc)
+    bytes_left_after_last_gc = bytes_free();
+
+
+  if (for_gc || compacting)
+    The_Memory_System()->object_table->post_store_whole_enchillada();
+
+  // enforce coherence at higher level
+}
 
+
+void Abstract_Object_Heap::walk_compact_or_make_free_objects(bool compacting, bool for_gc) {
   Chunk* dst_chunk = (Chunk*)startOfMemory();
+  Chunk* dead_chunk = NULL; // if not compacting, start of the free and dead objects before src_chunk
   for (__attribute__((unused))
        Chunk *src_chunk = dst_chunk,
         *next_src_chunk = NULL,
@@ -143,22 +170,36 @@ void Abstract_Object_Heap::scan_compact_or_make_free_objects(bool compacting, Ab
     Object* obj = src_chunk->object_from_chunk();
     next_src_chunk = obj->nextChunk();
 
-    if (obj->isFreeObject())
+    if (obj->isFreeObject()) {
+      if (dead_chunk == NULL)
+        dead_chunk = src_chunk;
       continue;
+    }
 
     Oop oop = obj->as_oop();
 
     if (for_gc) {
       if (!obj->is_marked()) {
         The_Memory_System()->object_table->free_oop(oop  COMMA_FALSE_OR_NOTHING);
-        if (!compacting)
-          src_chunk->make_free_object((char*)next_src_chunk - (char*)src_chunk, 0);
+        if (dead_chunk == NULL)
+          dead_chunk = src_chunk;
         continue;
       }
       obj->unmark_without_store_barrier();
     }
-    if (!compacting)
+    if (!compacting) {
+      if (dead_chunk != NULL)
+        make_free_chunk(dead_chunk, (char*)src_chunk - (char*)dead_chunk);
+      dead_chunk = NULL;
+      continue;
+    }
+
+    if (for_gc  &&  is_pinned_in_gc(src_chunk, next_src_chunk)) {
+      if (dst_chunk < src_chunk)
+        make_free_chunk(dst_chunk, (char*)src_chunk - (char*)dst_chunk);
+      dst_chunk = next_src_chunk;
       continue;
+    }
 
     Object_p new_obj_addr = (Object_p)(Object*)((char*)dst_chunk + ((char*)obj - (char*)src_chunk));
 
@@ -178,12 +219,228 @@ void Abstract_Object_Heap::scan_compact_or_make_free_objects(bool compacting, Ab
   }
   if (compacting)
     set_end_objects((Oop*)dst_chunk);
+  else if (dead_chunk != NULL)
+    make_free_chunk(dead_chunk, (char*)end_objects() - (char*)dead_chunk);
+}
 
 
-  if (for_gc || compacting)
-    The_Memory_System()->object_table->post_store_whole_enchillada();
+// Without the object table, the references have to be redirected before the objects slide,
+// so this records where each one will go in its backpointer for Memory_System::forward_to_compacted_addresses.
+// It has to agree with the compaction that follows.
+void Abstract_Object_Heap::set_backpointers_to_compacted_addresses(bool for_gc) {
+  if (!will_compact(true, for_gc))
+    return;
+  Chunk* dst_chunk = (Chunk*)startOfMemory();
+  for (Chunk *src_chunk = dst_chunk, *next_src_chunk = NULL;
+       src_chunk  <  (Chunk*)end_objects();
+       src_chunk = next_src_chunk) {
+    Object* obj = src_chunk->object_from_chunk();
+    next_src_chunk = obj->nextChunk();
+    if (obj->isFreeObject()  ||  (for_gc  &&  !obj->is_marked()))
+      continue;
+    if (for_gc  &&  is_pinned_in_gc(src_chunk, next_src_chunk)) {
+      obj->set_forwarding_backpointer(Oop::from_object(obj));
+      dst_chunk = next_src_chunk;
+      continue;
+    }
+    Object* new_obj_addr = (Object*)((char*)dst_chunk + ((char*)obj - (char*)src_chunk));
+    obj->set_forwarding_backpointer(Oop::from_object(new_obj_addr));
+    dst_chunk = (Chunk*)((char*)dst_chunk + ((char*)next_src_chunk - (char*)src_chunk));
+  }
+}
 
-  // enforce coherence at higher level
+
+// The oops of the dead objects are gone already (see Memory_System::free_unmarked_objects_in_object_table),
+// so only the live ones need to be looked at, and the bitmap leads from one to the next
+// without touching anything in between.
+void Abstract_Object_Heap::compact_or_make_free_objects_using_mark_bitmap(bool compacting) {
+  Memory_System* ms = The_Memory_System();
+  Atomic_Bitmap* marks = ms->mark_bitmap();
+  const size_t first_bit = ms->mark_bit_index(startOfMemory());
+  const size_t end_bit   = ms->mark_bit_index(end_objects());
+
+  Chunk* dst_chunk  = (Chunk*)startOfMemory();
+  Chunk* dead_chunk = dst_chunk; // start of the dead objects before the next live one
+  for (size_t i = marks->find_next_set(first_bit, end_bit);
+       i < end_bit;
+       i = marks->find_next_set(ms->mark_bit_index(dead_chunk), end_bit)) {
+    Object* obj = ms->object_for_mark_bit(i);
+    if (obj->isFreeObject()) { // was moved away while marking concurrently
+      marks->clear(i);
+      continue;
+    }
+    Chunk* src_chunk = obj->my_chunk();
+    Chunk* next_src_chunk = obj->nextChunk();
+
+    if (!compacting) {
+      if (dead_chunk < src_chunk)
+        make_free_chunk(dead_chunk, (char*)src_chunk - (char*)dead_chunk);
+    }
+    else if (is_pinned_in_gc(src_chunk, next_src_chunk)) {
+      if (dst_chunk < src_chunk)
+        make_free_chunk(dst_chunk, (char*)src_chunk - (char*)dst_chunk);
+      dst_chunk = next_src_chunk;
+    }
+    else if (src_chunk != dst_chunk) {
+      Object_p new_obj_addr = (Object_p)(Object*)((char*)dst_chunk + ((char*)obj - (char*)src_chunk));
+      The_Memory_System()->object_table->set_object_for(obj->as_oop(), new_obj_addr  COMMA_FALSE_OR_NOTHING);
+      int n_oops = (Oop*)next_src_chunk - (Oop*)src_chunk;
+      DEBUG_MULTIMOVE_CHECK(dst_chunk, src_chunk, n_oops);
+      memmove(dst_chunk, src_chunk, n_oops * sizeof(Oop));
+      dst_chunk = (Chunk*)&((Oop*)dst_chunk)[n_oops];
+    }
+    else
+      dst_chunk = next_src_chunk;
+    dead_chunk = next_src_chunk;
+  }
+  if (compacting)
+    set_end_objects((Oop*)dst_chunk);
+  else if (dead_chunk < (Chunk*)end_objects())
+    make_free_chunk(dead_chunk, (char*)end_objects() - (char*)dead_chunk);
+
+  marks->clear_range(first_bit, end_bit);
+}
+
+
+// With free lists, chunks still on them at the next GC are ones allocation could not use,
+// so compact once they add up to too much of the heap.
+// Lazy sweeping without them leaves the dead objects where they are, so a heap that is short of room
+// had better be compacted in the pause, as it would be without lazy sweeping.
+bool Abstract_Object_Heap::is_worth_compacting_in_gc() {
+  if (Memory_System::use_free_lists)
+    return u_int64(free_chunks.bytes()) * 100  >  u_int64(bytesUsed()) * Memory_System::compaction_threshold_percent;
+  if (Memory_System::lazy_sweep)
+    return bytesLeft()  <  u_int32((char*)_end - (char*)_start) / 4;
+  return true;
+}
+
+
+void Abstract_Object_Heap::make_free_chunk(Chunk* c, oop_int_t bytes) {
+  if (Memory_System::use_free_lists)
+    free_chunks.free_chunk(c, bytes);
+  else
+    c->make_free_object(bytes, 0);
+}
+
+
+// A lazily swept heap sweeps on till it finds a chunk, so allocation drives the sweep.
+bool Abstract_Object_Heap::has_free_chunk_for(oop_int_t total_bytes) {
+  for (;;) {
+    if (free_chunks.has_chunk_for(total_bytes))
+      return true;
+    if (!is_awaiting_sweep())
+      return false;
+    sweep_some(Memory_System::lazy_sweep_step_KB * 1024);
+  }
+}
+
+
+Chunk* Abstract_Object_Heap::allocate_from_free_chunks(oop_int_t total_bytes) {
+  if (!has_free_chunk_for(total_bytes))
+    return NULL;
+  Chunk* r = free_chunks.take(total_bytes);
+  if (check_assertions) {
+    assert(rank()  ==  Logical_Core::my_rank()
+           || Safepoint_for_moving_objects::is_held());
+    oopset_no_store_check((Oop*)r, Oop::from_bits(Oop::Illegals::allocated), total_bytes/sizeof(Oop));
+  }
+  return r;
+}
+
+
+// Called by the owning core while the others run: turns the dead objects of the next stretch
+// of at least the given size into free chunks, coalescing neighbours.
+// The marks are cleared only after sweep_next has moved past them, so other cores enumerating
+// this heap never take a live object there for a dead one (see is_accessible).
+void Abstract_Object_Heap::sweep_some(u_int32 bytes) {
+  if (!is_awaiting_sweep())
+    return;
+  Memory_System* ms = The_Memory_System();
+  Oop* stop = (u_int32)((char*)sweep_end - (char*)sweep_next) <= bytes  ?  sweep_end  :  (Oop*)((char*)sweep_next + bytes);
+
+  const u_int32 bytes_listed_before = free_chunks.bytes();
+  Chunk* c = (Chunk*)sweep_next;
+  Chunk* dead_chunk = NULL; // start of the dead or free objects before c
+  while ((Oop*)c < stop) {
+    Object* obj = c->object_from_chunk();
+    Chunk* next = obj->nextChunk();
+    if (obj->isFreeObject()  ||  !obj->is_marked()) {
+      if (dead_chunk == NULL)
+        dead_chunk = c;
+    }
+    else if (dead_chunk != NULL) {
+      enforce_coherence_before_store(dead_chunk, (char*)c - (char*)dead_chunk);
+      make_free_chunk(dead_chunk, (char*)c - (char*)dead_chunk);
+      enforce_coherence_after_store(dead_chunk, (char*)c - (char*)dead_chunk);
+      dead_chunk = NULL;
+    }
+    c = next;
+  }
+  if (dead_chunk != NULL) {
+    enforce_coherence_before_store(dead_chunk, (char*)c - (char*)dead_chunk);
+    make_free_chunk(dead_chunk, (char*)c - (char*)dead_chunk);
+    enforce_coherence_after_store(dead_chunk, (char*)c - (char*)dead_chunk);
+  }
+  bytes_left_after_last_gc += free_chunks.bytes() - bytes_listed_before; // what the GC found is only now to be had
+
+  const size_t first_bit = ms->mark_bit_index(sweep_next);
+  sweep_next = (Oop*)c;
+  OS_Interface::mem_fence();
+  ms->mark_bitmap()->clear_range(first_bit, ms->mark_bit_index(c));
+}
+
+
+// The pages beyond _end are reserved but untouched, so they cost nothing until the heap grows into them.
+void Abstract_Object_Heap::limit_capacity_to(u_int32 bytes) {
+  assert_always(_next == _start);
+  if (bytes < u_int32((char*)_end - (char*)_start))
+    _end = (Oop*)((char*)_start + bytes);
+  bytes_left_after_last_gc = bytesLeft();
+}
+
+
+// Like Squeak, grow by what is missing plus growHeadroom.
+// Only the owner moves _end, as it does when shrinking, unless nobody else is running;
+// a heap tried as another core's second chance is left for its owner to grow when it runs short itself.
+bool Abstract_Object_Heap::grow_to_leave(u_int32 bytes) {
+  if (bytesLeft() >= bytes)
+    return true;
+  if (_end >= _end_of_reservation)
+    return false;
+  if (rank() != Logical_Core::my_rank()  &&  !Safepoint_for_moving_objects::is_held())
+    return false;
+  Memory_System* ms = The_Memory_System();
+  int page_size = ms->get_page_size_used_in_heap();
+  Oop* new_end = (Oop*)((char*)_start + round_up_by_power_of_two((char*)_next - (char*)_start + bytes + ms->get_growHeadroom(), page_size));
+  if (new_end > _end_of_reservation)
+    new_end = _end_of_reservation;
+  if (Abstract_Mark_Sweep_Collector::print_gc)
+    lprintf("growing heap at %p from %d to %d KB\n", _start, bytesUsed() / 1024 + bytesLeft() / 1024, int(((char*)new_end - (char*)_start) / 1024));
+  if (check_many_assertions) // only the new part
+    for (Oop* p = _end;  p < new_end;  *p++ = Oop::from_bits(Oop::Illegals::zapped)) {}
+  bytes_left_after_last_gc += (char*)new_end - (char*)_end;
+  _end = new_end;
+  return bytesLeft() >= bytes;
+}
+
+
+// Called by the owner in a GC: give the pages past growHeadroom back to the OS once more than shrinkThreshold is free.
+void Abstract_Object_Heap::shrink_if_over_threshold(u_int32 min_capacity) {
+  Memory_System* ms = The_Memory_System();
+  if (bytesLeft() <= u_int32(ms->get_shrinkThreshold()))
+    return;
+  int page_size = ms->get_page_size_used_in_heap();
+  u_int32 capacity = round_up_by_power_of_two((char*)_next - (char*)_start + ms->get_growHeadroom(), page_size);
+  if (capacity < min_capacity)
+    capacity = min_capacity;
+  Oop* new_end = (Oop*)((char*)_start + capacity);
+  if (new_end >= _end)
+    return;
+  if (Abstract_Mark_Sweep_Collector::print_gc)
+    lprintf("shrinking heap at %p from %d to %d KB\n", _start, int(((char*)_end - (char*)_start) / 1024), capacity / 1024);
+  OS_Interface::release_heap_memory(new_end, (char*)_end - (char*)new_end);
+  _end = new_end;
+  bytes_left_after_last_gc = bytes_free();
 }
 
 
@@ -203,6 +460,6 @@ void Abstract_Object_Heap::zap_unused_portion() {
 
 
 void Abstract_Object_Heap::print(FILE*) {
-  lprintf("start 0x%x, next 0x%x, end 0x%x\n", _start, _next, _end);
+  lprintf("start %p, next %p, end %p\n", _start, _next, _end);
 }
 
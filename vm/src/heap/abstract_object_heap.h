@@ -18,6 +18,7 @@ class Abstract_Object_Heap {
   Oop* _start;
   Oop* _next;
   Oop* _end;
+  Oop* _end_of_reservation; // _end may grow up to here, see Memory_System::max_heap_MB
 
  public:
   int allocationsSinceLastQuery;
@@ -25,8 +26,20 @@ class Abstract_Object_Heap {
 
   int32 lowSpaceThreshold;
 
+ protected:
+  u_int32 bytes_left_after_last_gc;
+
+  // With Memory_System::lazy_sweep, the objects in [sweep_next, sweep_end) were there at the last GC
+  // and are dead unless marked; the owning core frees them a stretch at a time.
+  Oop* sweep_next;
+  Oop* sweep_end;
+
+  Free_Chunk_Lists free_chunks; // empty unless Memory_System::use_free_lists
+
+ public:
   Abstract_Object_Heap() {
-    _start = _next = _end = NULL; lowSpaceThreshold = 0;
+    _start = _next = _end = _end_of_reservation = NULL; lowSpaceThreshold = 0;  bytes_left_after_last_gc = 0;
+    sweep_next = sweep_end = NULL;
     allocationsSinceLastQuery = compactionsSinceLastQuery = 0;
   }
   bool is_initialized() { return _start != NULL; }
@@ -46,9 +59,9 @@ class Abstract_Object_Heap {
   void multistore( Oop* dst, Oop* src, oop_int_t n);
   void multistore( Oop* dst, Oop  src, oop_int_t n);
   void multistore( Oop* dst, Oop* end, Oop src);
-  static void record_class_header(Object* /* obj */, Oop klass) { if (klass.is_new()) unimplemented();  }
+  static inline void record_class_header(Object* obj, Oop klass);
 
-  static void possibleRootStore(Oop /* holder */, Oop /* contents */) { /*unimplemented*/ }
+  static inline void possibleRootStore(Oop holder, Oop contents);
   static void clearRootsTable() { lprintf("no clearRootsTable()\n"); }
 
 
@@ -58,10 +71,20 @@ class Abstract_Object_Heap {
 
 
   bool sufficientSpaceToAllocate(oop_int_t bytes);
+  inline bool has_room_without_gc(oop_int_t bytes);
+
+  // Growing and shrinking within the reservation, along the lines of Squeak's growHeadroom and shrinkThreshold
+  void limit_capacity_to(u_int32 bytes);
+  bool grow_to_leave(u_int32 bytes);
+  void shrink_if_over_threshold(u_int32 min_capacity);
   Chunk* allocateChunk(oop_int_t total_bytes);
+  inline Oop* bump_next(int n_oops);
+  Chunk* allocate_from_free_chunks(oop_int_t total_bytes);
+  bool has_free_chunk_for(oop_int_t total_bytes);
   Object_p object_address_unchecked(Oop)  { fatal("abstract"); }
 
   Object* accessibleObjectAfter(Object*);
+  inline bool is_accessible(Object*);
   Object* firstAccessibleObject();
   Oop     initialInstanceOf(Oop);
 
@@ -75,7 +98,9 @@ class Abstract_Object_Heap {
   Object*  end_objects_without_preheader() { return (Object*)_next; } // addr past objects
 
   u_int32 bytesLeft() { return (char*)_end - (char*)_next; }
+  u_int32 bytes_free() { return bytesLeft() + free_chunks.bytes(); }
   int bytesUsed() { return (char*)_next - (char*)_start; }
+  u_int32 get_bytes_left_after_last_gc() { return bytes_left_after_last_gc; }
 
   void     set_end_objects(Oop* x) {
     Oop* old_next = check_many_assertions ? _next : NULL;
@@ -105,6 +130,20 @@ class Abstract_Object_Heap {
 
   void zap_unused_portion();
   void scan_compact_or_make_free_objects(bool compacting, Abstract_Mark_Sweep_Collector* gc_or_null);
+  void set_backpointers_to_compacted_addresses(bool for_gc);
+ private:
+  void walk_compact_or_make_free_objects(bool compacting, bool for_gc);
+  void compact_or_make_free_objects_using_mark_bitmap(bool compacting);
+  bool will_compact(bool compacting, bool for_gc) { return compacting  &&  (!for_gc  ||  is_worth_compacting_in_gc()); }
+  bool is_worth_compacting_in_gc();
+  void make_free_chunk(Chunk*, oop_int_t bytes);
+  static inline bool is_pinned_in_gc(Chunk*, Chunk* next);
+ public:
+
+  bool is_awaiting_sweep() { return sweep_next < sweep_end; }
+  bool is_unswept(void* p) { return sweep_next <= (Oop*)p  &&  (Oop*)p < sweep_end; }
+  void sweep_some(u_int32 bytes);
+  void finish_sweep() { while (is_awaiting_sweep())  sweep_some(bytesUsed()); }
 
 
   Oop get_stats() { fatal("abstract"); }
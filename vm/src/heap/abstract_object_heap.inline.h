@@ -37,18 +37,29 @@ inline void Abstract_Object_Heap::enforce_coherence_after_store_into_object_by_i
 
 
 
-inline bool Abstract_Object_Heap::sufficientSpaceToAllocate(oop_int_t bytes) {
+// Only the owner or a safepoint holder may sweep for a free chunk, others just look at the untouched space
+inline bool Abstract_Object_Heap::has_room_without_gc(oop_int_t bytes) {
   u_oop_int_t minFree = lowSpaceThreshold + bytes + Object::BaseHeaderSize;
+  if (bytesLeft() >= minFree)
+    return true;
+  return Memory_System::use_free_lists
+     &&  (rank() == Logical_Core::my_rank()  ||  Safepoint_for_moving_objects::is_held())
+     &&  bytes_free() >= minFree  &&  has_free_chunk_for(bytes);
+}
 
+
+inline bool Abstract_Object_Heap::sufficientSpaceToAllocate(oop_int_t bytes) {
   if (Trace_GC_For_Debugging && The_Squeak_Interpreter()->debugging_tracer() != NULL  &&  The_Squeak_Interpreter()->debugging_tracer()->force_gc())
     ;
-  else if (bytesLeft() >= minFree)
+  else if (has_room_without_gc(bytes))
     return true;
 
   if (The_Squeak_Interpreter()->safepoint_ability->is_able()) // might be allocating a context
     The_Memory_System()->fullGC("sufficientSpaceToAllocate");
 
-  if (bytesLeft() >= minFree)
+  if (has_room_without_gc(bytes))
+    return true;
+  if (grow_to_leave(lowSpaceThreshold + bytes + Object::BaseHeaderSize))
     return true;
 
   /*  implement this
@@ -64,7 +75,19 @@ inline bool Abstract_Object_Heap::sufficientSpaceToAllocate(oop_int_t bytes) {
 }
 
 
+// A GC compacting a heap leaves the large objects where they are and compacts each stretch between them on its own,
+// so multi-megabyte ByteArrays and Forms are never copied. Compacting all heaps still moves them, see compact_all_heaps.
+inline bool Abstract_Object_Heap::is_pinned_in_gc(Chunk* c, Chunk* next) {
+  return Memory_System::large_object_KB != 0
+     &&  u_int32((char*)next - (char*)c)  >=  Memory_System::large_object_KB * 1024;
+}
+
+
 inline Chunk* Abstract_Object_Heap::allocateChunk(oop_int_t total_bytes) {
+  if (Memory_System::use_free_lists) {
+    Chunk* c = allocate_from_free_chunks(total_bytes);
+    if (c != NULL)  return c;
+  }
 
   bool enoughSpace = sufficientSpaceToAllocate(total_bytes);
   if (!enoughSpace) {
@@ -75,12 +98,15 @@ inline Chunk* Abstract_Object_Heap::allocateChunk(oop_int_t total_bytes) {
     The_Squeak_Interpreter()->forceInterruptCheck();
   }
   int n = convert_byte_count_to_oop_count(total_bytes);
-  if (_next + n  >=  _end) {
+  if (_next + n  >=  _end  &&  Memory_System::use_free_lists) {
+    Chunk* c = allocate_from_free_chunks(total_bytes); // the GC may have found one
+    if (c != NULL)  return c;
+  }
+  Oop* r = bump_next(n);
+  if (r == NULL) {
     fatal("allocateChunk should never fail, but there is not enough space for the requested bytes");
     return NULL;
   }
-  Oop* r = _next;
-  _next += n;
   if (check_assertions) {
     // make sure the heaps are only modified by the associated cores
     assert(rank()  ==  Logical_Core::my_rank()
@@ -97,15 +123,38 @@ inline Chunk* Abstract_Object_Heap::allocateChunk(oop_int_t total_bytes) {
 
 
 
+// With TLABs, other cores carve their buffers out of this heap without a safepoint, so the owner must bump atomically, too.
+inline Oop* Abstract_Object_Heap::bump_next(int n_oops) {
+  if (!Memory_System::is_using_tlabs()) {
+    if (_next + n_oops  >=  _end)  return NULL;
+    Oop* r = _next;
+    _next += n_oops;
+    return r;
+  }
+  for (;;) {
+    Oop* r = _next;
+    if (r + n_oops  >=  _end)  return NULL;
+    if (OS_Interface::atomic_compare_and_swap((void**)&_next, r, r + n_oops))
+      return r;
+  }
+}
+
+
 inline Object* Abstract_Object_Heap::accessibleObjectAfter(Object* obj) {
   for (;;) {
     obj = next_object(obj);
-    if (obj == NULL  ||  !obj->isFreeObject())
+    if (obj == NULL  ||  is_accessible(obj))
       return obj;
   }
 }
 
 
+// An unmarked object that a lazy sweep has yet to reach is garbage, and its oop is gone already.
+inline bool Abstract_Object_Heap::is_accessible(Object* obj) {
+  return !obj->isFreeObject()  &&  (!is_unswept(obj)  ||  obj->is_marked());
+}
+
+
 inline int Abstract_Object_Heap::rank() { return The_Memory_System()->rank_for_address(_start); }
 
 
@@ -136,8 +185,20 @@ inline bool Abstract_Object_Heap::verify_address_in_heap(void* addr) {
   assert_always_msg(_start <= (Oop*)addr
                     &&                (Oop*)addr < _next,
                     "object is not a valid address");
-  assert_always_msg((oop_int_t(addr) & (sizeof(Object*)-1)) == 0,
+  assert_always_msg((intptr_t(addr) & (sizeof(Object*)-1)) == 0,
                     "object is not aligned");
   return true;
 }
 
+
+
+// The class header is a pointer, too; see Nursery.
+inline void Abstract_Object_Heap::record_class_header(Object* obj, Oop klass) {
+  if (Memory_System::is_using_nurseries())
+    The_Memory_System()->publish_if_young_object_escapes(obj, klass);
+}
+
+inline void Abstract_Object_Heap::possibleRootStore(Oop holder, Oop contents) {
+  if (Memory_System::is_using_nurseries()  &&  holder.is_mem())
+    The_Memory_System()->publish_if_young_object_escapes(holder.as_object(), contents);
+}
@@ -0,0 +1,104 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+#include "headers.h"
+
+
+void Free_Chunk_Lists::clear() {
+  for (int i = 0;  i < num_classes;  ++i)
+    heads[i] = NULL;
+  _bytes = 0;
+}
+
+
+int Free_Chunk_Lists::class_for(oop_int_t bytes) {
+  u_int32 words = bytes / sizeof(Oop);
+  if (words < u_int32(exact_word_sizes))
+    return words;
+  int log_words = 31 - OS_Interface::leading_zeros(words);
+  return exact_word_sizes + log_words - 6;
+}
+
+
+oop_int_t Free_Chunk_Lists::size_of(Chunk* c) {
+  return c->object_from_chunk()->sizeOfFree() + preheader_byte_size;
+}
+
+
+Chunk*& Free_Chunk_Lists::link(Chunk* c) {
+  return *(Chunk**)((char*)c + preheader_byte_size + sizeof(Oop));
+}
+
+
+// Turns the chunk into a free object, and keeps it if it can hold a link.
+void Free_Chunk_Lists::free_chunk(Chunk* c, oop_int_t bytes) {
+  c->make_free_object(bytes, 3);
+  if (bytes < min_listed_bytes)
+    return;
+  Chunk*& head = heads[class_for(bytes)];
+  link(c) = head;
+  head = c;
+  _bytes += bytes;
+}
+
+
+// Returns where the link to a chunk that fits is kept, or NULL.
+Chunk** Free_Chunk_Lists::find(oop_int_t bytes) {
+  int k = class_for(bytes);
+  if (k < exact_word_sizes) {
+    // all chunks in one of these lists have the same size, so the first one will do if any
+    for (int i = k;  i < exact_word_sizes;  ++i)
+      if (heads[i] != NULL  &&  fits(i * sizeof(Oop), bytes))
+        return &heads[i];
+    k = exact_word_sizes;
+  }
+  for (int i = k;  i < num_classes;  ++i) {
+    int probes = 0;
+    for (Chunk** p = &heads[i];  *p != NULL  &&  probes < max_first_fit_probes;  p = &link(*p), ++probes)
+      if (fits(size_of(*p), bytes))
+        return p;
+  }
+  return NULL;
+}
+
+
+Chunk* Free_Chunk_Lists::take(oop_int_t bytes) {
+  Chunk** p = find(bytes);
+  if (p == NULL)
+    return NULL;
+  Chunk* c = *p;
+  oop_int_t chunk_bytes = size_of(c);
+  *p = link(c);
+  _bytes -= chunk_bytes;
+
+  // Free the rest before the caller overwrites the header, so the heap can be walked all along.
+  if (chunk_bytes > bytes)
+    free_chunk((Chunk*)((char*)c + bytes), chunk_bytes - bytes);
+  return c;
+}
+
+
+bool Free_Chunk_Lists::verify(Abstract_Object_Heap* h) {
+  u_int32 sum = 0;
+  for (int i = 0;  i < num_classes;  ++i)
+    for (Chunk* c = heads[i];  c != NULL;  c = link(c)) {
+      assert_always(h->contains(c));
+      assert_always(c->object_from_chunk()->isFreeObject());
+      assert_always(class_for(size_of(c)) == i);
+      sum += size_of(c);
+    }
+  assert_always(sum == _bytes);
+  return true;
+}
+
@@ -0,0 +1,54 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+// The free chunks a heap's sweep leaves in place, sorted by size so allocation can reuse them,
+// see Memory_System::use_free_lists.
+// Small chunks get a list per size in words, so they are taken without searching;
+// bigger ones are binned by powers of two and taken first-fit, and the rest of the chunk goes back.
+// The link lives in the word after the free header; smaller chunks just stay in the heap as holes.
+// Like the bump pointer, only the owning core uses these, or another one holding a safepoint.
+
+class Free_Chunk_Lists {
+  static const int exact_word_sizes = 64;
+  static const int power_of_two_classes = 32 - 6; // 6 is log2(exact_word_sizes)
+  static const int num_classes = exact_word_sizes + power_of_two_classes;
+  static const int max_first_fit_probes = 8; // per power-of-two class, before trying the next one
+
+  Chunk* heads[num_classes];
+  u_int32 _bytes;
+
+ public:
+  static const oop_int_t min_listed_bytes = preheader_byte_size + sizeof(Oop) + sizeof(Chunk*);
+  static const oop_int_t min_free_bytes   = preheader_byte_size + sizeof(Oop); // see Chunk::make_free_object
+
+  Free_Chunk_Lists() { clear(); }
+  void clear();
+
+  void free_chunk(Chunk*, oop_int_t bytes);
+  Chunk* take(oop_int_t bytes);
+  bool has_chunk_for(oop_int_t bytes) { return find(bytes) != NULL; }
+  u_int32 bytes() { return _bytes; }
+
+  bool verify(Abstract_Object_Heap*);
+
+ private:
+  static int class_for(oop_int_t bytes);
+  static oop_int_t size_of(Chunk*);
+  static Chunk*& link(Chunk*);
+  static bool fits(oop_int_t chunk_bytes, oop_int_t bytes) {
+    return chunk_bytes == bytes  ||  chunk_bytes >= bytes + min_free_bytes;
+  }
+  Chunk** find(oop_int_t bytes);
+};
+
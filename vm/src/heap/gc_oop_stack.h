@@ -21,17 +21,20 @@ class GC_Oop_Stack {
     ~Contents() { if (next_contents != NULL) { delete next_contents; next_contents = NULL;  } }
  } *contents, *free_contents;
   int next_elem;
+  int depth;
 
 public:
-   GC_Oop_Stack() { contents = NULL;  free_contents = NULL; next_elem = N; }
+   GC_Oop_Stack() { contents = NULL;  free_contents = NULL; next_elem = N; depth = 0; }
     ~GC_Oop_Stack() {
       if (contents != NULL) { delete contents; contents = NULL;  }
       if (free_contents != NULL) { delete free_contents; free_contents = NULL; }
     }
 
   void push(Object* x) {
-    if (next_elem < N)
+    if (next_elem < N) {
       contents->objs[next_elem++] = x;
+      ++depth;
+    }
     else {
       if (free_contents == NULL)
         contents = new Contents(contents);
@@ -47,8 +50,10 @@ public:
   }
 
   bool is_empty() { return next_elem == N  &&  contents == NULL; }
+  int size() { return depth; }
 
   Object* pop() {
+    --depth;
     Object* r = contents->objs[--next_elem];
     if (next_elem == 0) {
       next_elem = N;
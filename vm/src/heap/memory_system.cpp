@@ -15,6 +15,7 @@
 #include "headers.h"
 
 bool     Memory_System::use_huge_pages = On_Tilera;
+bool     Memory_System::use_transparent_huge_pages = false;
 bool     Memory_System::replicate_methods = false; // if true methods are put on read-mostly heap
 bool     Memory_System::replicate_all = true; // if true, all (non-contexts) are allowed in read-mostly heap
 bool     Memory_System::OS_mmaps_up = On_Apple;
@@ -22,8 +23,28 @@ u_int32  Memory_System::memory_per_read_write_heap = 0;
 u_int32  Memory_System::log_memory_per_read_mostly_heap = 0;
 u_int32  Memory_System::memory_per_read_mostly_heap = 0;
 u_int32  Memory_System::log_memory_per_read_write_heap = 0;
+u_int32  Memory_System::nursery_KB = 0;
+bool     Memory_System::use_mark_bitmap = false;
+bool     Memory_System::lazy_sweep = false;
+u_int32  Memory_System::lazy_sweep_step_KB = 64;
+bool     Memory_System::use_free_lists = false;
+int      Memory_System::compaction_threshold_percent = 25;
+int      Memory_System::object_table_compaction_percent = 0;
+u_int32  Memory_System::large_object_KB = 0;
+bool     Memory_System::parallel_heap_scans = true;
+bool     Memory_System::background_snapshots = false;
+pid_t    Memory_System::background_snapshot_pid = 0;
+int      Memory_System::background_snapshot_semaphore_index = -1;
+bool     Memory_System::last_background_snapshot_succeeded = false;
+u_int32  Memory_System::tlab_KB = 0;
+bool     Memory_System::borrow_space = false;
+int      Memory_System::borrow_until_percent_free = 10;
+int      Memory_System::lender_ranks[Max_Number_Of_Cores];
+u_int32  Memory_System::bytes_per_nursery = 0;
   int    Memory_System::round_robin_period = 1;
-  size_t Memory_System::min_heap_MB =  On_iOS ? 32 : On_Tilera ? 256 : 1024; // Fewer GCs on Mac
+  size_t Memory_System::min_heap_MB =  On_iOS ? 32 : On_Tilera ? 256 : sizeof(void*) == 8 ? 512 : 1024; // Fewer GCs on Mac; on 64-bit hosts both heaps must fit below 2GB, see heap_address_hint
+  size_t Memory_System::max_heap_MB = 0;
+  bool   Memory_System::home_to_numa_nodes = false;
 
 # define FOR_ALL_HEAPS(rank, mutability) \
   FOR_ALL_RANKS(rank) \
@@ -42,8 +63,12 @@ Memory_System::Memory_System() {
   global_GC_values->mutator_start_time = 0;
   global_GC_values->last_gc_ms = 0;
   global_GC_values->inter_gc_ms = 0;
+  global_GC_values->marking_concurrently = false;
+  global_GC_values->mark_work_pool = NULL;
+  global_GC_values->mark_bitmap = NULL;
 
   page_size_used_in_heap = 0;
+  moved_object_copies_count = 0;
 
   for (int rank = 0;  rank < Max_Number_Of_Cores;  ++rank)
     for (int mutability = 0;  mutability < max_num_mutabilities;  ++mutability)
@@ -59,6 +84,21 @@ void Memory_System::finished_adding_objects_from_snapshot() {
   // now all objects are in the heap, so we are also sure that this file is
   // in memory and the filesystem link is not to be used by mmap anymore
   OS_Interface::unlink_heap_file();
+
+  if (use_transparent_huge_pages)
+    report_transparent_huge_pages();
+}
+
+
+void Memory_System::report_transparent_huge_pages() {
+  size_t bytes = read_write_memory_past_end - read_mostly_memory_base;
+  int64_t kb = OS_Interface::get_huge_page_kb_in_range(read_mostly_memory_base, bytes);
+  if (kb < 0)
+    lprintf("Cannot tell how many transparent huge pages back the heaps.\n");
+  else
+    lprintf("Transparent huge pages: obtained %lld of %d (%lld MB of %d MB mapped for the heaps).\n",
+            (long long)(kb * 1024 / transparent_huge_page_size),  int(bytes / transparent_huge_page_size),
+            (long long)(kb / 1024),  int(bytes / Mega));
 }
 
 void Memory_System::enforce_coherence_after_each_core_has_stored_into_its_own_heap() {
@@ -85,6 +125,33 @@ void Memory_System::enforce_coherence_before_this_core_stores_into_all_heaps() {
 
 
 
+void Parallel_Heap_Scan::run() {
+  if (!Memory_System::is_scanning_heaps_in_parallel()) {
+    FOR_ALL_RANKS(r)
+      scan_heaps_of(r);
+    return;
+  }
+  parallelHeapScanMessage_class(this).send_to_other_cores();
+  scan_heaps_of(Logical_Core::my_rank());
+  while (!are_all_helpers_finished())
+    Message_Statics::process_any_incoming_messages(false);
+  OS_Interface::mem_fence();
+}
+
+
+// Only ever run in parallel, since each core has to check its own interpreter
+class Interpreter_And_Heap_Verification: public Parallel_Heap_Scan {
+  void scan_heaps_of(int rank) {
+    Memory_System* ms = The_Memory_System();
+    The_Squeak_Interpreter()->verify();
+    ms->heaps[rank][Memory_System::read_mostly]->verify();
+    ms->heaps[rank][Memory_System:: read_write]->verify();
+    if (Memory_System::is_using_nurseries())
+      ms->heaps[rank][Memory_System::read_write]->get_nursery()->verify();
+  }
+};
+
+
 bool Memory_System::verify_if(bool condition) {
   if (!condition)
     return true;
@@ -92,7 +159,10 @@ bool Memory_System::verify_if(bool condition) {
   // do this one at a time because the read_mostly heap messages are really flying around
   zapUnusedPortionOfHeapMessage_class().send_to_all_cores();
 
-  verifyInterpreterAndHeapMessage_class().send_to_all_cores();
+  if (is_scanning_heaps_in_parallel()  &&  !On_Tilera)
+    Interpreter_And_Heap_Verification().run();
+  else
+    verifyInterpreterAndHeapMessage_class().send_to_all_cores();
 
   return object_table->verify();
 }
@@ -143,6 +213,23 @@ void Memory_System::fullGC(const char* why) {
 }
 
 
+// A GC may sweep heaps in place, see Abstract_Object_Heap::is_worth_compacting_in_gc;
+// this slides all objects down, for when only a contiguous stretch will do.
+void Memory_System::compact_all_heaps(const char* why) {
+  Safepoint_for_moving_objects sf(why);
+  Safepoint_Ability sa(false);
+  finish_lazy_sweeping_everywhere();
+  The_Squeak_Interpreter()->preGCAction_everywhere(false);  // false because caches are oop-based, and we just move objs
+  scan_compact_or_make_free_objects_everywhere(true, NULL);
+  The_Squeak_Interpreter()->postGCAction_everywhere(false);
+}
+
+
+void Memory_System::record_overwritten_oop_for_concurrent_mark(Oop x) {
+  Abstract_Mark_Sweep_Collector::record_overwritten_oop(x);
+}
+
+
 void Memory_System::level_out_heaps_if_needed() {
   if (global_GC_values->inter_gc_ms  <  global_GC_values->last_gc_ms) {
     lprintf("inter_gc_ms is %d, last_gc_ms is %d; may level out\n",
@@ -158,6 +245,7 @@ void Memory_System::level_out_heaps_if_needed() {
 
       Safepoint_for_moving_objects sf("level_out_heaps_if_needed");
       Safepoint_Ability sa(false);
+      finish_lazy_sweeping_everywhere();
 
       Object* first = biggest->firstAccessibleObject();
       Object* first_object_to_spread;
@@ -171,6 +259,7 @@ void Memory_System::level_out_heaps_if_needed() {
         The_Squeak_Interpreter()->preGCAction_everywhere(false); // false because caches are oop-based, and we just move objs
         flushFreeContextsMessage_class().send_to_all_cores();
         shuffle_or_spread_last_part_of_a_heap(first_object_to_spread, 0, Logical_Core::num_cores - 1, false, false, true);
+        forward_moved_objects();
         The_Squeak_Interpreter()->postGCAction_everywhere(false);
         The_Memory_System()->verify_if(check_many_assertions);
         lprintf("Done spreading objects around to prevent GC storms\n"); // by spreading only excess if needed
@@ -191,15 +280,42 @@ Multicore_Object_Heap* Memory_System::biggest_heap() {
 }
 
 
-void Memory_System::finalize_weak_arrays_since_we_dont_do_incrementalGC() {
-  fullGC("finalize_weak_arrays_since_we_dont_do_incrementalGC");
+// What the image takes to be a cheap collection. Only a full mark finalizes weak arrays, so without -incremental_gc
+// this is a full GC, as it always was. With it: scavenge my nursery, sweep a little if lazy, and do a bounded amount
+// of marking towards the next full GC, see Abstract_Mark_Sweep_Collector::do_incremental_gc_step.
+// The remark that ends that mark finalizes the weak arrays found along the way; its sweep is left to later calls.
+void Memory_System::incrementalGC() {
+  if (The_Squeak_Interpreter()->am_receiving_objects_from_snapshot())
+    return;
+  if (!Abstract_Mark_Sweep_Collector::incremental_gc) {
+    fullGC("incrementalGC");
+    return;
+  }
+  Nursery* n = my_nursery();
+  if (n != NULL  &&  !is_marking_concurrently()  &&  The_Squeak_Interpreter()->safepoint_ability->is_able())
+    n->scavenge("incrementalGC");
+  if (lazy_sweep)
+    do_lazy_sweep_step();
+  Abstract_Mark_Sweep_Collector::do_incremental_gc_step();
+}
+
+
+// The hash stays with the references, so that the hashed collections holding them stay valid.
+static void copy_hash(Object_p from, Object_p to, bool twoWay) {
+  oop_int_t* from_hdrp = &from->baseHeader;  oop_int_t from_hdr = *from_hdrp;
+  oop_int_t*   to_hdrp = &to  ->baseHeader;  oop_int_t   to_hdr = *to_hdrp;
+  if (twoWay)
+    The_Memory_System()->store_enforcing_coherence(from_hdrp, (from_hdr & ~Object::HashMask)  |  (to_hdr & Object::HashMask), from);
+  The_Memory_System()->store_enforcing_coherence(to_hdrp, (to_hdr & ~Object::HashMask)  |  (from_hdr & Object::HashMask), to);
 }
 
 
-void Memory_System::swapOTEs(Oop* o1, Oop* o2, int len) {
+void Memory_System::swapOTEs(Oop* o1, Oop* o2, int len, bool copyHash) {
   for (int i = 0;  i < len;  ++i) {
     Object_p obj1 = o1[i].as_object();
     Object_p obj2 = o2[i].as_object();
+    if (copyHash)
+      copy_hash(obj1, obj2, true);
 
     obj2->set_object_address_and_backpointer(o1[i]  COMMA_TRUE_OR_NOTHING);
     obj1->set_object_address_and_backpointer(o2[i]  COMMA_TRUE_OR_NOTHING);
@@ -240,14 +356,8 @@ protected:
 public:
   void copyHashes() {
     if (!copyHash) return;
-    for (int i = 0;  i < len;  ++i) {
-      Object_p obj1 = o1[i].as_object();  oop_int_t* hdr1p = &obj1->baseHeader;  oop_int_t hdr1 = *hdr1p;
-      Object_p obj2 = o2[i].as_object();  oop_int_t* hdr2p = &obj2->baseHeader;  oop_int_t hdr2 = *hdr2p;
-      if (twoWay) {
-        The_Memory_System()->store_enforcing_coherence(hdr1p, (hdr1 & ~Object::HashMask)  |  (hdr2 & Object::HashMask), obj1);
-      }
-      The_Memory_System()->store_enforcing_coherence(hdr2p, (hdr2 & ~Object::HashMask)  |  (hdr1 & Object::HashMask), obj2);
-    }
+    for (int i = 0;  i < len;  ++i)
+      copy_hash(o1[i].as_object(), o2[i].as_object(), twoWay);
   }
 
   virtual const char* class_name() { return "Abstract_Become_Closure"; }
@@ -290,6 +400,9 @@ public:
 bool Memory_System::become_with_twoWay_copyHash(Oop array1, Oop array2, bool twoWayFlag, bool copyHashFlag) {
   Safepoint_for_moving_objects sf("become");
   Safepoint_Ability sa(false);
+  // swapping object table entries would let other cores see young objects
+  tenure_all_nurseries("become");
+  finish_lazy_sweeping_everywhere(); // the closures below would visit dead objects
 
   if (!array1.isArray()  ||  !array2.isArray())  return false;
   Object_p a1o = array1.as_object();
@@ -303,20 +416,26 @@ bool Memory_System::become_with_twoWay_copyHash(Oop array1, Oop array2, bool two
       The_Squeak_Interpreter()->set_process_object_layout_timestamp(The_Squeak_Interpreter()->process_object_layout_timestamp() + 1);
 
 
-  // sync?
-  if (twoWayFlag  &&  copyHashFlag) {
+  // Without the object table, the closures below are the only way.
+  // A one-way become scans too: the old oops must go, and only a scan can replace them.
+  if (twoWayFlag  &&  !Omit_Object_Table) {
     swapOTEs(a1o->as_oop_p() + Object::BaseHeaderSize/sizeof(Oop),
              a2o->as_oop_p() + Object::BaseHeaderSize/sizeof(Oop),
-             (a1o->lastPointer() - Object::BaseHeaderSize) / sizeof(Oop)  +  1);
+             (a1o->lastPointer() - Object::BaseHeaderSize) / sizeof(Oop)  +  1,
+             copyHashFlag);
+    The_Squeak_Interpreter()->sync_with_roots();
+    flushInterpreterCachesMessage_class().send_to_all_cores(); // cached methods of an old class would be wrong
     return true;
   }
 
   if (twoWayFlag) {
     Two_Way_Become_Closure bc(a1o, a2o, copyHashFlag);
+    bc.copyHashes();
     do_all_oops_including_roots_here(&bc, true); // will not do the contents of the arrays themselves
   }
   else {
     One_Way_Become_Closure bc(a1o, a2o, copyHashFlag);
+    bc.copyHashes();
     do_all_oops_including_roots_here(&bc, true); // will not do the contents of the arrays themselves
   }
   flushInterpreterCachesMessage_class().send_to_all_cores();
@@ -324,11 +443,70 @@ bool Memory_System::become_with_twoWay_copyHash(Oop array1, Oop array2, bool two
 }
 
 
+// Redirects each reference to an object that is moving to where its backpointer says it is going.
+class Forwarding_Closure: public Oop_Closure {
+public:
+  Forwarding_Closure() : Oop_Closure() {}
+
+  void value(Oop* p, Object_p containing_obj_or_null) {
+    Oop x = *p;
+    if (!x.is_mem())
+      return;
+    Oop new_x = x.as_object()->backpointer();
+    if (new_x != x) // not a mutation, so no read-mostly object is evacuated for it
+      The_Memory_System()->store_enforcing_coherence_if_in_heap(p, new_x, (Object_p)NULL);
+  }
+  virtual const char* class_name() { return "Forwarding_Closure"; }
+};
+
+
+void Memory_System::forward_all_references() {
+  Forwarding_Closure fc;
+  do_all_oops_including_roots_here(&fc, true);
+  if (is_using_nurseries())
+    FOR_ALL_RANKS(rank)
+      heaps[rank][read_write]->get_nursery()->forward_remembered_set();
+  flushInterpreterCachesMessage_class().send_to_all_cores(); // they hash on the oops
+}
+
+
+void Memory_System::remember_moved_object_copy(Chunk* c, int bytes) {
+  Safepoint_for_moving_objects::assert_held();
+  if (moved_object_copies_count == max_moved_object_copies)
+    forward_moved_objects();
+  moved_object_copies[moved_object_copies_count].chunk = c;
+  moved_object_copies[moved_object_copies_count].bytes = bytes;
+  ++moved_object_copies_count;
+}
+
+
+// One scan for a whole batch of moves, see Object::move_to_heap
+void Memory_System::forward_moved_objects() {
+  if (moved_object_copies_count == 0)
+    return;
+  Safepoint_for_moving_objects sf("forward_moved_objects");
+  Safepoint_Ability sa(false);
+  forward_all_references();
+  for (int i = 0;  i < moved_object_copies_count;  ++i)
+    moved_object_copies[i].chunk->make_free_object(moved_object_copies[i].bytes, 2);
+  moved_object_copies_count = 0;
+}
+
+
+// Called with all the marks in place, before any core compacts its heaps.
+void Memory_System::forward_to_compacted_addresses(bool for_gc) {
+  FOR_ALL_HEAPS(rank, mutability)
+    heaps[rank][mutability]->set_backpointers_to_compacted_addresses(for_gc);
+  forward_all_references();
+}
+
+
 
 Logical_Core* Memory_System::coreWithSufficientSpaceToAllocate(oop_int_t bytes, int mutability) {
   Multicore_Object_Heap* h = heaps[Logical_Core::my_rank()][mutability];
   int minFree = bytes + 10000 + h->lowSpaceThreshold; // may not be necessary
-  if  ( h->sufficientSpaceToAllocate(minFree) )
+  // when borrowing, a full heap of mine is no reason to collect while the second chance core has room
+  if  ( borrow_space  ?  h->has_room_without_gc(minFree)  :  h->sufficientSpaceToAllocate(minFree) )
     return Logical_Core::my_core();
 
   if  ( heaps[second_chance_cores_for_allocation[mutability]][mutability]->sufficientSpaceToAllocate(minFree))
@@ -362,6 +540,13 @@ bool Memory_System::sufficientSpaceAfterGC(oop_int_t minFree, int mutability) {
   if (heaps[second_chance_cores_for_allocation[mutability]][mutability]->sufficientSpaceToAllocate(minFree + extra))
     return true;
 
+  if (gc_may_leave_heaps_uncompacted()) {
+    compact_all_heaps("sufficientSpaceAfterGC");
+    set_second_chance_cores_for_allocation(mutability);
+    if (heaps[second_chance_cores_for_allocation[mutability]][mutability]->sufficientSpaceToAllocate(minFree + extra))
+      return true;
+  }
+
   fatal("growObjectMemory");
   // oop_int_t growSize = minFree - bytesLeft() + The_Memory_System()->get_growHeadroom();
   //growObjectMemory(growSize);
@@ -370,6 +555,42 @@ bool Memory_System::sufficientSpaceAfterGC(oop_int_t minFree, int mutability) {
 
 
 
+// Borrowing: rather than collect as soon as my heap is full, take slabs (TLABs) from the heap with the most room,
+// reserved with an atomic bump of its end, and only collect once the heaps together are low on space.
+// The borrowed objects belong to the lender's heap from then on.
+Chunk* Memory_System::borrow_chunk_for_a_new_object(oop_int_t total_bytes) {
+  const int my_rank = Logical_Core::my_rank();
+  int lender = lender_ranks[my_rank];
+  if (lender == my_rank  ||  !heaps[lender][read_write]->tlab_has_room_for(total_bytes)) {
+    lender = rank_to_borrow_from();
+    if (lender < 0)
+      return NULL;
+    lender_ranks[my_rank] = lender;
+  }
+  return heaps[lender][read_write]->allocate_in_tlab(total_bytes);
+}
+
+
+// -1 if all the read_write heaps together have less than borrow_until_percent_free left, time for a GC
+int Memory_System::rank_to_borrow_from() {
+  const int my_rank = Logical_Core::my_rank();
+  u_int64 free = 0, capacity = 0;
+  int best = -1;
+  u_int32 best_bytesLeft = tlab_bytes();
+  FOR_ALL_RANKS(i) {
+    Multicore_Object_Heap* h = heaps[i][read_write];
+    free     += h->bytes_free();
+    capacity += h->bytes_free() + h->bytesUsed();
+    if (i != my_rank  &&  h->bytesLeft() > best_bytesLeft) {
+      best_bytesLeft = h->bytesLeft();
+      best = i;
+    }
+  }
+  return free * 100  <  capacity * borrow_until_percent_free  ?  -1  :  best;
+}
+
+
+
 u_int32 Memory_System::maxContiguousBytesLeft() {
   u_int32 r = 0;
   FOR_ALL_RANKS(i)
@@ -412,13 +633,43 @@ void Memory_System::handle_low_space_signals() {
 }
 
 
-Oop Memory_System::initialInstanceOf(Oop x) {
-  Oop r;
-  FOR_ALL_HEAPS(rank, mutability) {
-    if ((r = heaps[rank][mutability]->initialInstanceOf(x)) != The_Squeak_Interpreter()->roots.nilObj)
-      return r;
+// Each core looks for the first instance in each of its heaps, then the first heap that has one wins.
+class Instance_Search: public Parallel_Heap_Scan {
+  Oop klass;
+  int after_heap_index;
+  Oop first_instances[Max_Number_Of_Cores][Memory_System::max_num_mutabilities];
+
+  void scan_heaps_of(int rank) {
+    for (int mutability = 0;  mutability < Memory_System::max_num_mutabilities;  ++mutability)
+      first_instances[rank][mutability] =
+        rank * Memory_System::max_num_mutabilities + mutability  >  after_heap_index
+          ?  The_Memory_System()->heaps[rank][mutability]->initialInstanceOf(klass)
+          :  The_Squeak_Interpreter()->roots.nilObj;
   }
-  return r;
+public:
+  Instance_Search(Oop k, int a) : Parallel_Heap_Scan() { klass = k;  after_heap_index = a; }
+
+  Oop first_instance() {
+    FOR_ALL_RANKS(rank)
+      for (int mutability = 0;  mutability < Memory_System::max_num_mutabilities;  ++mutability)
+        if (first_instances[rank][mutability] != The_Squeak_Interpreter()->roots.nilObj)
+          return first_instances[rank][mutability];
+    return The_Squeak_Interpreter()->roots.nilObj;
+  }
+};
+
+
+// in the order of FOR_ALL_HEAPS
+Oop Memory_System::first_instance_in_heaps_after(Oop klass, int heap_index) {
+  Instance_Search s(klass, heap_index);
+  s.run();
+  return s.first_instance();
+}
+
+
+Oop Memory_System::initialInstanceOf(Oop x) {
+  tenure_all_nurseries("initialInstanceOf");
+  return first_instance_in_heaps_after(x, -1);
 }
 
 
@@ -432,13 +683,7 @@ Oop Memory_System::nextInstanceAfter(Oop x) {
   if (r != The_Squeak_Interpreter()->roots.nilObj)
     return r;
 
-  FOR_ALL_HEAPS(rank, mutability)
-    if (&heaps[rank][mutability] > &heaps[start_rank][start_mutability]) {
-      r = heaps[rank][mutability]->initialInstanceOf(klass);
-      if (r != The_Squeak_Interpreter()->roots.nilObj)
-        return r;
-    }
-  return r;
+  return first_instance_in_heaps_after(klass, start_rank * max_num_mutabilities + start_mutability);
 }
 
 
@@ -451,13 +696,15 @@ void Memory_System::snapshotCleanUp() {
 u_int32 Memory_System::bytesLeft() {
   u_int32 sum = 0;
   FOR_ALL_RANKS(i)
-    sum += heaps[i][read_write]->bytesLeft();
+    sum += heaps[i][read_write]->bytes_free();
   return sum;
 }
 
 
 void Memory_System::writeImageFile(char* image_name) {
-  writeImageFileIO(image_name);
+  int screenSize, fullScreenFlag;
+  The_Interactions.get_screen_info(&screenSize, &fullScreenFlag);
+  writeImageFileIO(image_name, screenSize, fullScreenFlag);
   fn_t setMacType = The_Interactions.load_function_from_plugin(Logical_Core::main_rank, "setMacFileTypeAndCreator", "FilePlugin");
   if (setMacType != NULL)  (*setMacType)(The_Memory_System()->imageName(), "STim", "FAST");
 }
@@ -479,7 +726,117 @@ static const int32 headerSize = 64;
 
 
 
-void Memory_System::writeImageFileIO(char* image_name) {
+void Snapshot_Output::flush() {
+  if (word_count == 0  ||  failed)
+    return;
+  size_t n = word_count * sizeof(int32);
+  if (file != NULL)
+    failed = fwrite(buffer, 1, n, file) != n;
+  else
+    for (char* p = (char*)buffer;  n > 0  &&  !failed;  ) {
+      ssize_t w = pwrite(fd, p, n, position);
+      if (w <= 0)
+        failed = true;
+      else {
+        p += w;  n -= w;  position += w;
+      }
+    }
+  if (failed)
+    perror("write: ");
+  bytes_written += word_count * sizeof(int32);
+  word_count = 0;
+}
+
+
+// Each core formats its own heaps and pwrites them at their place in the file.
+// The image leaves out the preheader of its first object, see write_image_file,
+// otherwise each heap takes as many bytes in the file as in memory.
+class Snapshot_Writing: public Parallel_Heap_Scan {
+  int fd;
+  u_int32* heap_offsets;
+  off_t positions[Max_Number_Of_Cores][Memory_System::max_num_mutabilities];
+  u_int64 sizes[Max_Number_Of_Cores][Memory_System::max_num_mutabilities];
+  bool is_first_heap[Max_Number_Of_Cores][Memory_System::max_num_mutabilities];
+  bool failed; // only ever set
+
+  void scan_heaps_of(int rank) {
+    for (int mutability = 0;  mutability < Memory_System::max_num_mutabilities;  ++mutability) {
+      Snapshot_Output out(fd, positions[rank][mutability]);
+      bool is_first_object = is_first_heap[rank][mutability];
+      The_Memory_System()->heaps[rank][mutability]->write_image_file(&out, heap_offsets, is_first_object);
+      out.flush();
+      if (out.has_failed()  ||  out.bytes() != sizes[rank][mutability])
+        failed = true;
+    }
+  }
+
+public:
+  Snapshot_Writing(int d, u_int32* offsets, off_t start) : Parallel_Heap_Scan() {
+    fd = d;
+    heap_offsets = offsets;
+    failed = false;
+    off_t position = start;
+    bool before_first_object = true;
+    Memory_System* ms = The_Memory_System();
+    FOR_ALL_RANKS(rank)
+      for (int mutability = 0;  mutability < Memory_System::max_num_mutabilities;  ++mutability) {
+        Multicore_Object_Heap* h = ms->heaps[rank][mutability];
+        u_int64 bytes = (char*)h->end_objects() - (char*)h->startOfMemory();
+        is_first_heap[rank][mutability] = before_first_object;
+        if (before_first_object  &&  bytes != 0) {
+          bytes -= preheader_byte_size;
+          before_first_object = false;
+        }
+        positions[rank][mutability] = position;
+        sizes[rank][mutability] = bytes;
+        position += bytes;
+      }
+  }
+  bool has_failed() { return failed; }
+};
+
+
+// Called in the snapshot pause, after which the caller resumes at once.
+// The child has only the calling thread, so it writes the heaps by itself and must not send any message,
+// and it sees the heaps and the object table as they were at the fork, since both are private to the process
+// (see background_snapshots); it exits without running the exit handlers of the VM.
+bool Memory_System::writeImageFile_in_background(char* image_name, int semaphore_index) {
+  assert_always(can_snapshot_in_background()  &&  !is_snapshotting_in_background());
+  int screenSize, fullScreenFlag;
+  The_Interactions.get_screen_info(&screenSize, &fullScreenFlag);
+  fflush(stdout);  fflush(stderr);
+  pid_t pid = fork();
+  if (pid == -1) {
+    perror("fork for background snapshot");
+    return false;
+  }
+  if (pid == 0) {
+    parallel_heap_scans = false;
+    writeImageFileIO(image_name, screenSize, fullScreenFlag);
+    _exit(The_Squeak_Interpreter()->successFlag  ?  0  :  1);
+  }
+  background_snapshot_semaphore_index = semaphore_index;
+  OS_Interface::mem_fence();
+  background_snapshot_pid = pid;
+  return true;
+}
+
+
+// Called by the main core from checkForInterrupts; signals the semaphore once the child is done
+void Memory_System::poll_background_snapshot() {
+  assert(Logical_Core::running_on_main());
+  int status;
+  pid_t r = waitpid(background_snapshot_pid, &status, WNOHANG);
+  if (r == 0)
+    return;
+  last_background_snapshot_succeeded = r == background_snapshot_pid  &&  WIFEXITED(status)  &&  WEXITSTATUS(status) == 0;
+  lprintf("background snapshot %s\n", last_background_snapshot_succeeded ? "written" : "failed");
+  background_snapshot_pid = 0;
+  The_Squeak_Interpreter()->signalSemaphoreWithIndex(background_snapshot_semaphore_index);
+}
+
+
+void Memory_System::writeImageFileIO(char* image_name, int screenSize, int fullScreenFlag) {
   // int32 headerStart = 0;
   FILE* f = fopen(image_name, "wb");
   if (f == NULL) {
@@ -490,36 +847,50 @@ void Memory_System::writeImageFileIO(char* image_name) {
   u_int32 heap_offsets[sizeof(heaps)/sizeof(heaps[0][0])];
   compute_snapshot_offsets(heap_offsets);
 
-  write_snapshot_header(f, heap_offsets);
+  write_snapshot_header(f, heap_offsets, screenSize, fullScreenFlag);
 
   if (!The_Squeak_Interpreter()->successFlag) {
     fclose(f);
     return;
   }
 
+  if (is_scanning_heaps_in_parallel()) {
+    fflush(f);
+    Snapshot_Writing w(fileno(f), heap_offsets, headerSize);
+    w.run();
+    if (w.has_failed())
+      The_Squeak_Interpreter()->success(false);
+    fclose(f);
+    return;
+  }
+
   if (fseek(f, headerSize, SEEK_SET)) {
     perror("seek");
     The_Squeak_Interpreter()->success(false);
     return;
   }
   bool is_first_object = true; // see comment in write_image_file
-  FOR_ALL_HEAPS(rank, mutability) {
-    heaps[rank][mutability]->write_image_file(f, heap_offsets, is_first_object /* passed by REF */ );
+  {
+    Snapshot_Output out(f);
+    FOR_ALL_HEAPS(rank, mutability) {
+      heaps[rank][mutability]->write_image_file(&out, heap_offsets, is_first_object /* passed by REF */ );
+    }
+    out.flush();
+    if (out.has_failed())
+      The_Squeak_Interpreter()->primitiveFail();
   }
   fclose(f);
   return;
 }
 
-void Memory_System::write_snapshot_header(FILE* f, u_int32* heap_offsets) {
+void Memory_System::write_snapshot_header(FILE* f, u_int32* heap_offsets, int screenSize, int fullScreenFlag) {
   putLong(The_Squeak_Interpreter()->image_version, f);
   putLong(headerSize, f);
   putLong(bytesUsed() - preheader_byte_size /* Squeak 64-bit VM bug workaround */, f);
   // For explanation of preheader_byte_size above and below, see long comment about Squeak compatibility in write_image_file -- dmu 6/10
-  putLong((int32)read_mostly_memory_base + preheader_byte_size/* Squeak 64-bit VM bug workaround */, f); // start of memory;
+  putLong(int32(intptr_t(read_mostly_memory_base)) + preheader_byte_size/* Squeak 64-bit VM bug workaround */, f); // start of memory;
   putLong(adjust_for_snapshot(The_Squeak_Interpreter()->roots.specialObjectsOop.as_object(), heap_offsets), f);
   putLong(max_lastHash(), f);
-  int screenSize, fullScreenFlag;
-  The_Interactions.get_screen_info(&screenSize, &fullScreenFlag);
   putLong(screenSize, f);
   putLong(fullScreenFlag, f);
   int32 extraVMMemory = 0;
@@ -546,6 +917,7 @@ void Memory_System::compute_snapshot_offsets(u_int32* offsets) {
 
 
 Oop Memory_System::firstAccessibleObject() {
+  tenure_all_nurseries("firstAccessibleObject");
   FOR_ALL_HEAPS(rank, mutability)  {
     Object* obj = heaps[rank][mutability]->firstAccessibleObject();
     if (obj != NULL)
@@ -589,9 +961,10 @@ int Memory_System::round_robin_rank() {
 }
 
 
+// When growing, this reserves address space for max_heap_MB, see initial_bytes_per_read_write_heap
 int Memory_System::calculate_total_read_write_pages(int page_size) {
-  int min_heap_bytes_for_all_cores = min_heap_MB * Mega;
-  int min_heap_bytes_per_core = divide_and_round_up(min_heap_bytes_for_all_cores, Logical_Core::group_size);
+  size_t min_heap_bytes_for_all_cores = size_t(is_growing_heaps() ? max_heap_MB : min_heap_MB) * Mega; // may exceed 4GB with Compressed_Oops
+  int min_heap_bytes_per_core = divide_and_round_up(min_heap_bytes_for_all_cores, size_t(Logical_Core::group_size));
   int min_pages_per_core = divide_and_round_up(min_heap_bytes_per_core, page_size);
   int pages_per_core = round_up_to_power_of_two(min_pages_per_core); // necessary so per-core bytes is power of two
   // lprintf("page_size %d, Mega %d, min_heap_bytes_for_all_cores %d, Logical_Core::group_size %d,  min_pages_per_core %d,  pages_per_core %d, pages_per_core * Logical_Core::group_size %d\n",
@@ -600,14 +973,20 @@ int Memory_System::calculate_total_read_write_pages(int page_size) {
 }
 
 
+int Memory_System::initial_bytes_per_read_write_heap() {
+  int bytes_per_core = divide_and_round_up(size_t(min_heap_MB) * Mega,  size_t(Logical_Core::group_size));
+  return round_up_by_power_of_two(bytes_per_core, page_size_used_in_heap);
+}
+
+
 int Memory_System::calculate_bytes_per_read_mostly_heap(int /* page_size */) {
-  int min_bytes_per_core = divide_and_round_up(min_heap_MB * Mega,  Logical_Core::group_size);
+  int min_bytes_per_core = divide_and_round_up(size_t(min_heap_MB) * Mega,  size_t(Logical_Core::group_size));
   return round_up_to_power_of_two(min_bytes_per_core);
 }
 
 
 int Memory_System::calculate_total_read_mostly_pages(int page_size) {
-  return divide_and_round_up(calculate_bytes_per_read_mostly_heap(page_size) * Logical_Core::group_size, page_size);
+  return divide_and_round_up(size_t(calculate_bytes_per_read_mostly_heap(page_size)) * Logical_Core::group_size, size_t(page_size));
 }
 
 void Memory_System::initialize_from_snapshot(int32 snapshot_bytes, int32 sws, int32 fsf, int32 lastHash) {
@@ -621,14 +1000,16 @@ void Memory_System::initialize_from_snapshot(int32 snapshot_bytes, int32 sws, in
   snapshot_window_size.initialize(sws, fsf);
 
 
-  u_int32 total_read_write_memory_size     =  rw_pages *  page_size_used_in_heap;
-  u_int32 total_read_mostly_memory_size    =  rm_pages *  page_size_used_in_heap;
+  size_t total_read_write_memory_size     =  size_t(rw_pages) *  page_size_used_in_heap;
+  size_t total_read_mostly_memory_size    =  size_t(rm_pages) *  page_size_used_in_heap;
 
   OS_Interface::check_requested_heap_size(total_read_mostly_memory_size + total_read_write_memory_size);
 
   read_mostly_memory_base = read_write_memory_base = NULL;
 
   map_read_write_and_read_mostly_memory(getpid(), total_read_write_memory_size, total_read_mostly_memory_size);
+  if (use_mark_bitmap) // contains() relies on the heaps being contiguous, too
+    global_GC_values->mark_bitmap = new Atomic_Bitmap(size_t(read_write_memory_past_end - read_mostly_memory_base) / sizeof(Oop));
 
   memory_per_read_write_heap  = total_read_write_memory_size   / Logical_Core::group_size;
   memory_per_read_mostly_heap = calculate_bytes_per_read_mostly_heap(page_size_used_in_heap);
@@ -642,6 +1023,11 @@ void Memory_System::initialize_from_snapshot(int32 snapshot_bytes, int32 sws, in
   
   log_memory_per_read_write_heap = log_of_power_of_two(memory_per_read_write_heap);
   log_memory_per_read_mostly_heap = log_of_power_of_two(memory_per_read_mostly_heap);
+  if (Omit_Object_Table  &&  nursery_KB != 0)
+    fatal("nurseries need the object table, -nursery_KB is not supported with Omit_Object_Table");
+  // leave at least half of each read_write heap for old objects
+  bytes_per_nursery = min(divide_and_round_up(nursery_KB * 1024, page_size_used_in_heap) * page_size_used_in_heap,
+                          memory_per_read_write_heap / 2);
   object_table = new Multicore_Object_Table();
 
   init_buf ib = {
@@ -649,9 +1035,10 @@ void Memory_System::initialize_from_snapshot(int32 snapshot_bytes, int32 sws, in
     read_mostly_memory_base, read_write_memory_base,
     total_read_write_memory_size, memory_per_read_write_heap, log_memory_per_read_write_heap,
     total_read_mostly_memory_size, memory_per_read_mostly_heap, log_memory_per_read_mostly_heap,
-    page_size_used_in_heap, getpid(),
+    page_size_used_in_heap, getpid(), OS_Interface::get_heap_memfd(),
     object_table,
-    global_GC_values
+    global_GC_values,
+    bytes_per_nursery
   };
 
   initialize_main(&ib);
@@ -665,9 +1052,12 @@ void Memory_System::set_page_size_used_in_heap() {
     if (!OS_Interface::ask_for_huge_pages(co_pages + inco_pages))
       use_huge_pages = false;
   }
-  lprintf("Using %s pages.\n", use_huge_pages ? "huge" : "normal");
-  int hps = huge_page_size,  nps = normal_page_size; // compiler bug, need to alias these
-  page_size_used_in_heap = use_huge_pages ? hps : nps;
+  if (use_huge_pages)
+    use_transparent_huge_pages = false;
+  lprintf("Using %s pages.\n", use_huge_pages ? "huge" : use_transparent_huge_pages ? "transparent huge" : "normal");
+  int hps = huge_page_size,  nps = normal_page_size,  thps = transparent_huge_page_size; // compiler bug, need to alias these
+  // heaps, and so their boundaries, are whole transparent huge pages
+  page_size_used_in_heap = use_huge_pages ? hps : use_transparent_huge_pages ? thps : nps;
 }
 
 
@@ -717,8 +1107,18 @@ void Memory_System::map_heap_memory_in_one_request(int pid,
                                                    size_t grand_total,
                                                    size_t inco_size,
                                                    size_t co_size) {
-  read_mostly_memory_base = OS_Interface::map_heap_memory(grand_total, grand_total,
-                                            NULL, 0, pid, MAP_SHARED);
+  if (use_transparent_huge_pages  &&  Using_Threads)
+    read_mostly_memory_base = OS_Interface::map_memory_for_transparent_huge_pages(grand_total, transparent_huge_page_size,
+                                                                                  OS_Interface::heap_address_hint());
+  else if (can_snapshot_in_background())
+    read_mostly_memory_base = OS_Interface::reserve_memory(grand_total, OS_Interface::heap_address_hint());
+  else {
+    read_mostly_memory_base = OS_Interface::map_heap_memory(grand_total, grand_total,
+                                              NULL, 0, pid, MAP_SHARED);
+    if (use_transparent_huge_pages) // only helps if the file is in tmpfs and shmem_enabled allows it
+      OS_Interface::advise_transparent_huge_pages(read_mostly_memory_base, grand_total);
+  }
+  OS_Interface::check_heap_address_range(read_mostly_memory_base, grand_total);
   read_mostly_memory_past_end = read_mostly_memory_base + inco_size;
 
   read_write_memory_base      = read_mostly_memory_past_end;
@@ -800,8 +1200,10 @@ void Memory_System::initialize_helper() {
   if (Replicate_PThread_Memory_System  ||  Using_Processes)
     init_values_from_buffer(ib); // not needed with common structure
 
-  if (Using_Processes)
+  if (Using_Processes) {
+    OS_Interface::set_heap_memfd(ib->heap_memfd); // the main core's
     map_read_write_and_read_mostly_memory(ib->main_pid, ib->total_read_write_memory_size, ib->total_read_mostly_memory_size);
+  }
   
   create_my_heaps(ib);
   
@@ -841,6 +1243,7 @@ void Memory_System::init_values_from_buffer(init_buf* ib) {
   snapshot_window_size.initialize(ib->sws, ib->fsf);
 
   global_GC_values = ib->global_GC_values;
+  bytes_per_nursery = ib->bytes_per_nursery;
 }
 
 
@@ -855,6 +1258,10 @@ void Memory_System::create_my_heaps(init_buf* ib) {
                  memory_per_read_write_heap,
                  page_size_used_in_heap,
                  On_Tilera );
+  if (bytes_per_nursery)
+    h->create_nursery(bytes_per_nursery);
+  if (is_growing_heaps())
+    h->limit_capacity_to(initial_bytes_per_read_write_heap());
   heaps[my_rank][read_write] = h;
 
   h = new Multicore_Object_Heap();
@@ -874,17 +1281,98 @@ void Memory_System::create_my_heaps(init_buf* ib) {
 // xxxxxx I bet we could go back to parallel. -- dmu 4/09
 
 void Memory_System::scan_compact_or_make_free_objects_everywhere(bool compacting, Abstract_Mark_Sweep_Collector* gc_or_null) {
-  
+  if (gc_or_null != NULL) {
+    // before the mark bits go away, and before the oops of dead objects do
+    FOR_ALL_RANKS(r)
+      if (heaps[r][read_write]->get_nursery() != NULL)
+        heaps[r][read_write]->get_nursery()->forget_unmarked_remembered_objects();
+    if (use_mark_bitmap)
+      free_unmarked_objects_in_object_table();
+  }
+  if (Omit_Object_Table  &&  compacting)
+    forward_to_compacted_addresses(gc_or_null != NULL);
   enforce_coherence_before_each_core_stores_into_its_own_heap();
   scanCompactOrMakeFreeObjectsMessage_class m(compacting, gc_or_null);
   m.send_to_all_cores();
   enforce_coherence_after_each_core_has_stored_into_its_own_heap();
+  if (gc_or_null != NULL  &&  !Omit_Object_Table) {
+    compact_object_table_if_sparse();
+    object_table->rebalance_free_entries();
+  }
 }
 
 
 void Memory_System::scan_compact_or_make_free_objects_here(bool compacting, Abstract_Mark_Sweep_Collector* gc_or_null) {
+  Nursery* n = my_nursery();
+  // other cores' buffers in my heaps are free chunks already, and may be compacted or coalesced away now
+  heaps[Logical_Core::my_rank()][read_write ]->retire_tlabs();
+  heaps[Logical_Core::my_rank()][read_mostly]->retire_tlabs();
   heaps[Logical_Core::my_rank()][read_write ]->scan_compact_or_make_free_objects(compacting, gc_or_null);
   heaps[Logical_Core::my_rank()][read_mostly]->scan_compact_or_make_free_objects(compacting, gc_or_null);
+  if (n != NULL  &&  gc_or_null != NULL)
+    n->sweep_and_tenure_after_full_GC();
+  if (is_growing_heaps()  &&  gc_or_null != NULL)
+    heaps[Logical_Core::my_rank()][read_write]->shrink_if_over_threshold(initial_bytes_per_read_write_heap());
+}
+
+
+// Lazy sweeping: a GC leaves each heap that has room to spare unswept, and its core frees the dead objects
+// lazy_sweep_step_KB at a time from checkForInterrupts and incrementalGC; bump allocation never waits on it.
+// Only with use_free_lists can the space freed be allocated again before the heap is next compacted,
+// and then allocation sweeps on for itself, see Abstract_Object_Heap::has_free_chunk_for.
+// The oops of the dead objects are freed in the pause as usual, so only the heap walks need to know.
+void Memory_System::do_lazy_sweep_step() {
+  Multicore_Object_Heap* h = heaps[Logical_Core::my_rank()][read_write];
+  if (!h->is_awaiting_sweep())
+    h = heaps[Logical_Core::my_rank()][read_mostly];
+  h->sweep_some(lazy_sweep_step_KB * 1024);
+}
+
+
+void Memory_System::finish_lazy_sweep_here() {
+  heaps[Logical_Core::my_rank()][read_write ]->finish_sweep();
+  heaps[Logical_Core::my_rank()][read_mostly]->finish_sweep();
+}
+
+
+// Before anything that walks or moves all objects, or marks
+void Memory_System::finish_lazy_sweeping_everywhere() {
+  if (!lazy_sweep)
+    return;
+  FOR_ALL_HEAPS(rank, mutability)
+    if (heaps[rank][mutability]->is_awaiting_sweep()) {
+      finishLazySweepMessage_class().send_to_all_cores();
+      return;
+    }
+}
+
+
+// With a mark bitmap, the heaps need not look at dead objects at all if their oops are freed beforehand;
+// this has to be done for all heaps before any of them gets compacted and loses its marks.
+void Memory_System::free_unmarked_objects_in_object_table() {
+  object_table->pre_store_whole_enchillada();
+  object_table->free_entries_of_unmarked_objects();
+  object_table->post_store_whole_enchillada();
+}
+
+
+
+
+// After a spike, most of the object table may be free entries; renumber the surviving oops into as few segments
+// as will hold them and give the pages of the rest back to the OS.
+void Memory_System::compact_object_table_if_sparse() {
+  if (object_table_compaction_percent == 0  ||  !object_table->is_sparse(object_table_compaction_percent))
+    return;
+  finish_lazy_sweeping_everywhere(); // the scan below must not see the dead objects, whose oops are gone
+  object_table->pre_store_whole_enchillada();
+  int n = object_table->empty_sparsest_segments();
+  object_table->post_store_whole_enchillada();
+  if (n == 0)
+    return;
+  forward_all_references();
+  object_table->release_emptied_segments();
+  if (Abstract_Mark_Sweep_Collector::print_gc)
+    lprintf("released %d object table segments\n", n);
 }
 
 
@@ -920,6 +1408,7 @@ bool Memory_System::shuffle_or_spread(int first, int last,
   Safepoint_for_moving_objects sf("shuffle");
   Safepoint_Ability sa(false);
   fullGC("shuffle_or_spread");
+  finish_lazy_sweeping_everywhere();
   The_Squeak_Interpreter()->preGCAction_everywhere(false); // false because caches are oop-based, and we just move objs
   flushFreeContextsMessage_class().send_to_all_cores();
 
@@ -937,10 +1426,12 @@ bool Memory_System::shuffle_or_spread(int first, int last,
                                                move_read_write_to_read_mostly, 
                                                move_read_mostly_to_read_write, 
                                                spread)) {
+      forward_moved_objects();
       The_Squeak_Interpreter()->postGCAction_everywhere(false);
       return false;
     }
   }
+  forward_moved_objects();
   The_Squeak_Interpreter()->postGCAction_everywhere(false);
   if (spread) {
     FOR_ALL_RANKS(r)
@@ -1008,6 +1499,7 @@ bool Memory_System::moveAllToRead_MostlyHeaps() {
   flushFreeContextsMessage_class().send_to_all_cores();
 
   fullGC("moveAllToRead_MostlyHeaps");
+  finish_lazy_sweeping_everywhere();
   The_Squeak_Interpreter()->preGCAction_everywhere(false);  // false because caches are oop-based, and we just move objs
   u_int32 old_gcCount = global_GC_values->gcCount; // cannot tolerate GCs, ends gets messed up
 
@@ -1027,7 +1519,7 @@ bool Memory_System::moveAllToRead_MostlyHeaps() {
            ++n, ++dst_rank, dst_rank %= Logical_Core::group_size)  {
 
         if (n == Logical_Core::group_size) {
-          lprintf("moveAllToRead_MostlyHeaps failing; out of space\n", i);
+          lprintf("moveAllToRead_MostlyHeaps failing; out of space\n");
           return false;
         }
 
@@ -1036,6 +1528,7 @@ bool Memory_System::moveAllToRead_MostlyHeaps() {
 
         obj->move_to_heap(dst_rank, read_mostly, false);
         if (global_GC_values->gcCount != old_gcCount) {
+          forward_moved_objects();
           The_Squeak_Interpreter()->postGCAction_everywhere(false);
           lprintf("moveAllToRead_MostlyHeaps failing for core %d; GCed\n", i);
           return false;
@@ -1045,6 +1538,7 @@ bool Memory_System::moveAllToRead_MostlyHeaps() {
     }
     fprintf(stderr, "finished rank %d\n", i);
   }
+  forward_moved_objects();
   The_Squeak_Interpreter()->postGCAction_everywhere(false);
   return true;
 }
@@ -1145,7 +1639,7 @@ void Memory_System::pre_cohere(void* start, int nbytes) {
   // lprintf("pre_cohere start 0x%x %d\n", start, nbytes);
 
   if (!contains(start) && !object_table->probably_contains(start)) {
-    lprintf("pid %d, about_to_write_read_mostly_memory to bad address 0x%x 0x%x\n", getpid(), start, nbytes);
+    lprintf("pid %d, about_to_write_read_mostly_memory to bad address %p 0x%x\n", getpid(), start, nbytes);
     fatal();
   }
   aboutToWriteReadMostlyMemoryMessage_class(start, nbytes).send_to_other_cores();
@@ -1170,11 +1664,70 @@ void Memory_System::enforce_coherence_after_this_core_has_stored_into_all_heaps(
 }
 
 
+Abstract_Object_Heap* Memory_System::space_containing(void* obj) {
+  Multicore_Object_Heap* h = heap_containing(obj);
+  return is_address_young(obj) ? (Abstract_Object_Heap*)h->get_nursery() : h;
+}
+
+
+// The barrier for nurseries, see Nursery. Stores into private young objects need nothing.
+void Memory_System::publish_if_young_object_escapes(void* p, Oop x) {
+  if (!x.is_mem())
+    return;
+  Nursery* n = my_nursery();
+  if (n->is_private(p))
+    return;
+  if (n->is_private(x.as_object())  ||  n->is_remembered(x))
+    n->publish(x);
+}
+
+
+// Empties the nurseries, e.g. before enumerating all objects.
+// Returns false if some old space had no room left.
+bool Memory_System::tenure_all_nurseries(const char* why) {
+  if (!is_using_nurseries())
+    return true;
+  if (is_marking_concurrently())
+    fullGC(why); // markers hold addresses, so finish first; this also tenures what it can
+
+  Safepoint_for_moving_objects sf(why);
+  Safepoint_Ability sa(false);
+  const bool interpreting = The_Squeak_Interpreter()->is_initialized(); // see Nursery::scavenge
+  if (interpreting) {
+    The_Squeak_Interpreter()->preGCAction_everywhere(false);  // false because caches are oop-based, and we just move objs
+    flushFreeContextsMessage_class().send_to_all_cores();
+  }
+
+  bool ok = true;
+  FOR_ALL_RANKS(r)
+    if (!heaps[r][read_write]->get_nursery()->tenure_everything())
+      ok = false;
+
+  if (interpreting)
+    The_Squeak_Interpreter()->postGCAction_everywhere(false);
+  return ok;
+}
+
+
+class Parallel_Oop_Scan: public Parallel_Heap_Scan {
+  Oop_Closure* closure;
+
+  void scan_heaps_of(int rank) {
+    Memory_System* ms = The_Memory_System();
+    for (int mutability = 0;  mutability < Memory_System::max_num_mutabilities;  ++mutability)
+      ms->heaps[rank][mutability]->do_all_oops(closure);
+    if (Memory_System::is_using_nurseries())
+      ms->heaps[rank][Memory_System::read_write]->get_nursery()->do_all_oops(closure);
+  }
+public:
+  Parallel_Oop_Scan(Oop_Closure* oc) : Parallel_Heap_Scan() { closure = oc; }
+};
+
+
+// The closures used here only store into the object whose oop they are given, so the heaps can be done in parallel.
 void Memory_System::do_all_oops_including_roots_here(Oop_Closure* oc, bool sync_with_roots)  {
   The_Interactions.do_all_roots_here(oc);
-  for (int mutability = 0;  mutability < max_num_mutabilities;  ++mutability)
-    FOR_ALL_RANKS(r)
-      heaps[r][mutability]->do_all_oops(oc);
+  Parallel_Oop_Scan(oc).run();
   if (sync_with_roots)
     The_Squeak_Interpreter()->sync_with_roots();
 }
@@ -1183,9 +1736,9 @@ void Memory_System::do_all_oops_including_roots_here(Oop_Closure* oc, bool sync_
 
 void Memory_System::print() {
   lprintf("Memory_System:n");
-  lprintf("use_huge_pages: %d, min_heap_MB %d, replicate_methods %d, replicate_all %d, memory_per_read_write_heap 0x%x, log_memory_per_read_write_heap %d, , memory_per_read_mostly_heap 0x%x, log_memory_per_read_mostly_heap %d\n"
-                  "read_write_memory_base 0x%x, read_write_memory_past_end 0x%x, read_mostly_memory_base 0x%x, read_mostly_memory_past_end 0x%x, "
-                  "page_size_used_in_heap %d, round_robin_period %d, second_chance_cores_for_allocation[read_write] %d, second_chance_cores_for_allocation[read_mostly] %d,\n"
+  lprintf("use_huge_pages: %d, min_heap_MB %zd, replicate_methods %d, replicate_all %d, memory_per_read_write_heap 0x%x, log_memory_per_read_write_heap %d, , memory_per_read_mostly_heap 0x%x, log_memory_per_read_mostly_heap %d\n"
+                  "read_write_memory_base %p, read_write_memory_past_end %p, read_mostly_memory_base %p, read_mostly_memory_past_end %p, "
+                  "page_size_used_in_heap %zd, round_robin_period %d, second_chance_cores_for_allocation[read_write] %d, second_chance_cores_for_allocation[read_mostly] %d,\n"
                   "gcCount %d, gcMilliseconds %d, gcCycles %lld\n",
                   use_huge_pages, min_heap_MB, replicate_methods, replicate_all, memory_per_read_write_heap, log_memory_per_read_write_heap, memory_per_read_mostly_heap, log_memory_per_read_mostly_heap,
                   read_write_memory_base, read_write_memory_past_end, read_mostly_memory_base, read_mostly_memory_past_end,
@@ -1208,7 +1761,7 @@ void Memory_System::print_heaps() {
 
 # define DEF_SEC(T) \
 void Memory_System::store_enforcing_coherence(T* p, T x, Object_p dst_obj_to_be_evacuated_or_null) { \
-  if (sizeof(T) == bytes_per_oop) { DEBUG_STORE_CHECK((oop_int_t*)(p), (oop_int_t)(x)); } \
+  if (sizeof(T) == bytes_per_oop) { DEBUG_STORE_CHECK((oop_int_t*)(p), (oop_int_t)(intptr_t)(x)); } \
   assert(contains(p)); \
   if (is_address_read_write(p)) { *p = x; return; } \
   assert(!Safepoint_Ability::is_interpreter_able()); \
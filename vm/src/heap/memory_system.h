@@ -46,8 +46,10 @@
  * For thread-based systems, this is only done on the main core, and the other
  * cores do not need to map in any memory.
  *
- * A temporary file is used to ensure that all cores are working on the same
- * memory.
+ * A shared file is used to ensure that all cores are working on the same
+ * memory. Where Linux offers memfd_create, it is anonymous shared memory that the
+ * other processes open through /proc, otherwise a temporary file,
+ * see OS_Interface::map_heap_memory.
  */
 class Memory_System {
 
@@ -68,16 +70,42 @@ private:
   // huge pages at boot time to use the use_huge_pages flag (hugepages=56)
 public:
   static bool use_huge_pages;   // threadsafe readonly config value
+  static bool use_transparent_huge_pages; // threadsafe readonly config value, need no reservation unlike use_huge_pages
+  static const size_t transparent_huge_page_size = 2 * Mega;
   static size_t min_heap_MB;      // threadsafe readonly
+  static size_t max_heap_MB;      // threadsafe readonly, the read_write heaps start at min_heap_MB and may grow up to this
+  static bool is_growing_heaps() { return max_heap_MB > min_heap_MB; }
   static bool replicate_methods;// threadsafe readonly
   static bool replicate_all;    // threadsafe readonly
   static bool OS_mmaps_up;      // threadsafe readonly
+  static bool home_to_numa_nodes; // threadsafe readonly config value, see OS_Interface::home_memory_to_core
+  static u_int32 nursery_KB;    // threadsafe readonly config value, 0 means no nurseries
+  static bool use_mark_bitmap;  // threadsafe readonly config value, see Object::is_marked
+  static bool lazy_sweep;       // threadsafe readonly config value, implies use_mark_bitmap, see Abstract_Object_Heap::sweep_some
+  static u_int32 lazy_sweep_step_KB; // threadsafe readonly config value
+  static bool use_free_lists;   // threadsafe readonly config value, see Free_Chunk_Lists
+  static int  compaction_threshold_percent; // threadsafe readonly config value, see Abstract_Object_Heap::is_worth_compacting_in_gc
+  static int  object_table_compaction_percent; // threadsafe readonly config value, 0 means never, see compact_object_table_if_sparse
+  static u_int32 large_object_KB; // threadsafe readonly config value, 0 means none, see Abstract_Object_Heap::is_pinned_in_gc
+  static void set_large_object_KB(u_int32 kb) { large_object_KB = kb;  if (kb != 0) use_free_lists = true; } // the gaps they leave go on the free lists
+  static bool gc_may_leave_heaps_uncompacted() { return lazy_sweep || use_free_lists; }
+  static bool parallel_heap_scans; // threadsafe readonly config value, see Parallel_Heap_Scan
+  static bool is_scanning_heaps_in_parallel() { return parallel_heap_scans  &&  Using_Threads  &&  Logical_Core::group_size > 1; }
+  static bool background_snapshots; // threadsafe readonly config value, maps the heaps privately so a fork gets a copy-on-write view of them
+  static bool can_snapshot_in_background() { return background_snapshots  &&  Using_Threads; }
+  static u_int32 tlab_KB;       // threadsafe readonly config value, 0 unless allocating into other cores' heaps from buffers
+  static bool borrow_space;     // threadsafe readonly config value, see borrow_chunk_for_a_new_object
+  static int  borrow_until_percent_free; // threadsafe readonly config value
+  static const u_int32 default_tlab_KB = 64;
+  static bool is_using_tlabs() { return tlab_KB != 0  ||  borrow_space; }
+  static u_int32 tlab_bytes() { return (tlab_KB != 0  ?  tlab_KB  :  default_tlab_KB) * 1024; }
 
 private:
   static u_int32 memory_per_read_write_heap; // threadsafe readonly, will always be power of two
   static u_int32 memory_per_read_mostly_heap; // threadsafe readonly, will always be power of two
   static u_int32 log_memory_per_read_write_heap;  // threadsafe readonly
   static u_int32 log_memory_per_read_mostly_heap; // threadsafe readonly
+  static u_int32 bytes_per_nursery; // threadsafe readonly, top of each read_write heap, see Nursery
 
   char * read_write_memory_base,   * read_write_memory_past_end;
   char * read_mostly_memory_base,  * read_mostly_memory_past_end;
@@ -88,6 +116,9 @@ private:
     u_int32 gcCount, gcMilliseconds;
     u_int64 gcCycles;
     u_int32 mutator_start_time, last_gc_ms, inter_gc_ms;
+    bool marking_concurrently;
+    Parallel_Mark_Work_Pool* mark_work_pool;
+    Atomic_Bitmap* mark_bitmap; // one bit per word of all heaps, or NULL unless use_mark_bitmap
   };
   struct global_GC_values* global_GC_values;
 
@@ -121,16 +152,18 @@ public:
     int32 snapshot_bytes, sws, fsf, lastHash;
     char* read_mostly_memory_base;
     char* read_write_memory_base;
-    u_int32 total_read_write_memory_size;
+    size_t  total_read_write_memory_size;
     u_int32 memory_per_read_write_heap;
     u_int32 log_memory_per_read_write_heap;
-    u_int32 total_read_mostly_memory_size;
+    size_t  total_read_mostly_memory_size;
     u_int32 memory_per_read_mostly_heap;
     u_int32 log_memory_per_read_mostly_heap;
-    int32 page_size;
+    size_t page_size;
     int32 main_pid;
+    int32 heap_memfd;
     Multicore_Object_Table* object_table;
     struct global_GC_values* global_GC_values;
+    u_int32 bytes_per_nursery;
   };
 
 
@@ -142,6 +175,7 @@ public:
   inline Object* allocate_chunk_on_this_core_for_object_in_snapshot(Multicore_Object_Heap*, Object*);
 
   void finished_adding_objects_from_snapshot();
+  void report_transparent_huge_pages();
   static void set_round_robin_period(int x) { round_robin_period = x; }
 
 
@@ -149,7 +183,8 @@ public:
   
  
   int32 adjust_for_snapshot(void* addr, u_int32* address_offsets) const {
-    return (int32)addr - address_offsets[&heaps[rank_for_address(addr)][mutability_for_address(addr)] - &heaps[0][0]];
+    // with Compressed_Oops the high bits are dropped, as for the start of memory in the header
+    return int32(intptr_t(addr)) - address_offsets[&heaps[rank_for_address(addr)][mutability_for_address(addr)] - &heaps[0][0]];
   }
 
 
@@ -158,6 +193,7 @@ private:
   int calculate_total_read_write_pages(int);
   int calculate_total_read_mostly_pages(int);
   int calculate_bytes_per_read_mostly_heap(int);
+  int initial_bytes_per_read_write_heap();
   bool ask_Linux_for_huge_pages(int);
   int how_many_huge_pages();
   void request_huge_pages(int);
@@ -188,10 +224,16 @@ public:
   }
 
 
+  // Without the object table, the oop of an object is only known once it has been placed
+  Object* ask_cpu_core_to_add_object_from_snapshot_allocating_chunk(Object* src_obj_wo_preheader) {
+    return The_Interactions.add_object_from_snapshot_allocating_chunk(assign_rank_for_snapshot_object(), Oop(), src_obj_wo_preheader);
+  }
+
+
   Object* add_object_from_snapshot_to_a_local_heap_allocating_chunk(Oop dst_oop, Object* src_obj_wo_preheader) {
     Multicore_Object_Heap* h = local_heap_for_snapshot_object(src_obj_wo_preheader);
     Object* dst_obj = allocate_chunk_on_this_core_for_object_in_snapshot(h, src_obj_wo_preheader);
-    if (check_many_assertions) assert(((u_int32)dst_obj & (sizeof(Oop) - 1)) == 0);
+    if (check_many_assertions) assert(((intptr_t)dst_obj & (sizeof(Oop) - 1)) == 0);
     h->add_object_from_snapshot(dst_oop, dst_obj, src_obj_wo_preheader);
     return dst_obj;
   }
@@ -221,7 +263,7 @@ public:
   
   int rank_for_address(void* p) const {
     bool is_rw = is_address_read_write(p);
-    u_int32 delta  = (char*)p - (is_rw ? read_write_memory_base : read_mostly_memory_base);
+    size_t  delta  = (char*)p - (is_rw ? read_write_memory_base : read_mostly_memory_base);
     u_int32 result = delta >> (is_rw ? log_memory_per_read_write_heap : log_memory_per_read_mostly_heap);
     assert(result ==  delta / (is_rw ? memory_per_read_write_heap : memory_per_read_mostly_heap));
     assert(result < (u_int32)Logical_Core::group_size);
@@ -231,12 +273,27 @@ public:
   Multicore_Object_Heap* heap_containing(void* obj) {
     return heaps[rank_for_address(obj)][mutability_for_address(obj)];
   }
+  // like heap_containing, but a young object is found in the nursery of that heap
+  Abstract_Object_Heap* space_containing(void* obj);
+
+  static bool is_using_nurseries() { return bytes_per_nursery != 0; }
+
+  // The nursery is the top of each read_write heap, and the heap size is a power of two.
+  bool is_address_young(void* p) const {
+    return is_address_read_write(p)
+      &&  (((char*)p - read_write_memory_base) & (memory_per_read_write_heap - 1))  >=  memory_per_read_write_heap - bytes_per_nursery;
+  }
+  inline Nursery* my_nursery();
+
+  bool tenure_all_nurseries(const char* why);
+  void publish_if_young_object_escapes(void* p, Oop x);
 
 
 
 
 
   Object*  object_for_unchecked(Oop x) {
+    if (Omit_Object_Table) return (Object*)uintptr_t(u_oop_int_t(x.bits())); // the heap lies below 2GB, see check_heap_address_range
     Object* r = object_table->object_for(x);
     assert(!object_table->probably_contains(r));
     return r;
@@ -244,6 +301,7 @@ public:
 
 
   Object*  object_for(Oop x) {
+    if (Omit_Object_Table) return (Object*)uintptr_t(u_oop_int_t(x.bits()));
     return object_table->object_for(x);
   }
 
@@ -251,9 +309,17 @@ public:
 
   Logical_Core* coreWithSufficientSpaceToAllocate(oop_int_t bytes, int);
   bool sufficientSpaceAfterGC(oop_int_t, int);
+  Chunk* borrow_chunk_for_a_new_object(oop_int_t total_bytes);
+ private:
+  static int lender_ranks[Max_Number_Of_Cores]; // threadsafe: each core only uses its own
+  int rank_to_borrow_from();
+ public:
 
   void scan_compact_or_make_free_objects_everywhere(bool compacting, Abstract_Mark_Sweep_Collector*);
   void scan_compact_or_make_free_objects_here(bool compacting, Abstract_Mark_Sweep_Collector*);
+  void do_lazy_sweep_step();
+  void finish_lazy_sweep_here();
+  void finish_lazy_sweeping_everywhere();
   u_int32 bytesLeft();
   u_int32 maxContiguousBytesLeft();
 
@@ -266,20 +332,52 @@ public:
   void set_growHeadroom(int32 h) { global_GC_values->growHeadroom = h; }
   void set_shrinkThreshold(int32 s) { global_GC_values->shrinkThreshold = s; }
   int32 get_growHeadroom() { return global_GC_values->growHeadroom; }
+  size_t get_page_size_used_in_heap() { return page_size_used_in_heap; }
   int32 get_shrinkThreshold() { return global_GC_values->shrinkThreshold; }
 
   void fullGC(const char*);
-  void incrementalGC() {  if (check_assertions) lprintf("no incremental GC\n"); }
-  void finalize_weak_arrays_since_we_dont_do_incrementalGC();
+  void compact_all_heaps(const char*);
+
+  bool is_marking_concurrently() { return global_GC_values->marking_concurrently; }
+  void set_marking_concurrently(bool b) { global_GC_values->marking_concurrently = b;  OS_Interface::mem_fence(); }
+  Parallel_Mark_Work_Pool* get_mark_work_pool() { return global_GC_values->mark_work_pool; }
+  void set_mark_work_pool(Parallel_Mark_Work_Pool* p) { global_GC_values->mark_work_pool = p; }
+  void record_overwritten_oop_for_concurrent_mark(Oop);
+
+  Atomic_Bitmap* mark_bitmap() { return global_GC_values->mark_bitmap; }
+  size_t mark_bit_index(void* p) const { return size_t((Oop*)p - (Oop*)read_mostly_memory_base); }
+  Object* object_for_mark_bit(size_t i) const { return (Object*)((Oop*)read_mostly_memory_base + i); }
+ private:
+  void free_unmarked_objects_in_object_table();
+  void compact_object_table_if_sparse();
+ public:
+
+  void incrementalGC();
 
   bool become_with_twoWay_copyHash(Oop, Oop, bool, bool);
+
 protected:
-  void swapOTEs(Oop* o1, Oop* o2, int len);
+  void swapOTEs(Oop* o1, Oop* o2, int len, bool copyHash);
   void level_out_heaps_if_needed();
 public:
 
+  // Without the object table, a moved object leaves its old copy in place, with a backpointer to the new one,
+  // till forward_moved_objects has fixed up the references to it.
+  void remember_moved_object_copy(Chunk*, int bytes);
+  void forward_moved_objects();
+private:
+  void forward_to_compacted_addresses(bool for_gc);
+  void forward_all_references();
+  static const int max_moved_object_copies = Omit_Object_Table ? 1024 : 1;
+  struct { Chunk* chunk; int bytes; } moved_object_copies[max_moved_object_copies];
+  int moved_object_copies_count;
+public:
+
   Oop initialInstanceOf(Oop);
   Oop nextInstanceAfter(Oop);
+ private:
+  Oop first_instance_in_heaps_after(Oop klass, int heap_index);
+ public:
 
   Oop firstAccessibleObject();
   Oop nextObject(Oop obj);
@@ -297,9 +395,17 @@ public:
 
   void snapshotCleanUp();
   void writeImageFile(char*);
+  bool writeImageFile_in_background(char*, int semaphore_index);
+  void poll_background_snapshot();
+  static bool is_snapshotting_in_background() { return background_snapshot_pid != 0; }
+  static bool did_last_background_snapshot_succeed() { return last_background_snapshot_succeeded; }
 private:
-  void writeImageFileIO(char* image_name);
-  void write_snapshot_header(FILE*, u_int32*);
+  static pid_t background_snapshot_pid; // 0 unless a child is writing the image; only the main core reaps it
+  static int   background_snapshot_semaphore_index;
+  static bool  last_background_snapshot_succeeded;
+
+  void writeImageFileIO(char* image_name, int screenSize, int fullScreenFlag);
+  void write_snapshot_header(FILE*, u_int32*, int screenSize, int fullScreenFlag);
   int32 max_lastHash();
 
 
@@ -345,12 +451,14 @@ public:
 
   void store_enforcing_coherence(Oop* p, Oop x, Object_p dst_obj_to_be_evacuated_or_null) {
     assert(contains(p));
+    if (is_marking_concurrently())  record_overwritten_oop_for_concurrent_mark(*p); // snapshot-at-the-beginning barrier
+    if (is_using_nurseries())  publish_if_young_object_escapes(p, x);
     store_enforcing_coherence((oop_int_t*)p, x.bits(), dst_obj_to_be_evacuated_or_null);
   }
   // used when p may be either in the heap or in a C++ structure
   void store_enforcing_coherence_if_in_heap(Oop* p, Oop x, Object_p dst_obj_to_be_evacuated_or_null) {
     if (contains(p))
-      store_enforcing_coherence((oop_int_t*)p, x.bits(), dst_obj_to_be_evacuated_or_null);
+      store_enforcing_coherence(p, x, dst_obj_to_be_evacuated_or_null);
     else *p = x;
   }
 
@@ -28,3 +28,8 @@ inline Object* Memory_System::allocate_chunk_on_this_core_for_object_in_snapshot
   return obj;
 }
 
+
+inline Nursery* Memory_System::my_nursery() {
+  return heaps[Logical_Core::my_rank()][read_write]->get_nursery();
+}
+
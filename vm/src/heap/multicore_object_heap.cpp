@@ -25,8 +25,35 @@ void Multicore_Object_Heap::initialize_multicore(int hash, char* mem, int size,
   lastHash = hash;
   if (do_homing  &&  Logical_Core::group_size > 1)
     home_to_this_tile(page_size);
+  else if (Memory_System::home_to_numa_nodes  &&  Logical_Core::group_size > 1)
+    OS_Interface::home_memory_to_core(mem, size, Logical_Core::my_rank()); // all of it, the heap may grow
 }
 
+// Big objects and nearly full heaps are left to allocateChunk under a safepoint, which may GC.
+// The old buffer's tail stays a free chunk until the next GC.
+bool Multicore_Object_Heap::refill_tlab(oop_int_t total_bytes) {
+  u_int32 tlab_bytes = Memory_System::tlab_bytes();
+  if (u_int32(total_bytes) > tlab_bytes / 2
+  ||  bytesLeft() < tlab_bytes + lowSpaceThreshold)
+    return false;
+  int n = convert_byte_count_to_oop_count(tlab_bytes);
+  Oop* p = bump_next(n);
+  if (p == NULL)
+    return false;
+  ((Chunk*)p)->make_free_object(tlab_bytes, 4);
+  TLAB* t = &tlabs[Logical_Core::my_rank()];
+  t->next = p;
+  t->end  = p + n;
+  return true;
+}
+
+
+void Multicore_Object_Heap::retire_tlabs() {
+  for (int i = 0;  i < Max_Number_Of_Cores;  ++i)
+    tlabs[i].next = tlabs[i].end = NULL;
+}
+
+
 void Multicore_Object_Heap::home_to_this_tile(int page_size) {
   for (char* p = (char*)_start;  p < (char*)_end;  p += page_size)
     *p = '\xff';
@@ -34,6 +61,15 @@ void Multicore_Object_Heap::home_to_this_tile(int page_size) {
     verify_homing(page_size);
 }
 
+// Take the nursery from the top of my space, so that rank_for_address still works for young objects.
+void Multicore_Object_Heap::create_nursery(int nursery_bytes) {
+  assert_always(bytesLeft() > u_int32(nursery_bytes));
+  _end = _end_of_reservation = (Oop*)((char*)_end - nursery_bytes);
+  bytes_left_after_last_gc = bytesLeft();
+  nursery = new Nursery();
+  nursery->initialize_nursery(this, _end, nursery_bytes);
+}
+
 int a_global;
 
 bool Multicore_Object_Heap::verify_homing(int page_size) {
@@ -86,7 +122,7 @@ void Multicore_Object_Heap::add_object_from_snapshot(Oop dst_oop, Object* dst_ob
   memcpy(dst_chunk_wo_preheader,  src_chunk_wo_preheader,  total_src_bytes);
   // beRootIfOld -- What to do about old-young barrier?
 
-  dst_obj->set_preheader(dst_oop); // now that baseHeader is set, can do this
+  dst_obj->set_preheader(Omit_Object_Table ? dst_obj->as_oop() : dst_oop); // now that baseHeader is set, can do this
 }
 
 
@@ -94,7 +130,7 @@ void Multicore_Object_Heap::add_object_from_snapshot(Oop dst_oop, Object* dst_ob
 
 void Multicore_Object_Heap::flushExternalPrimitives() {
   FOR_EACH_OBJECT_IN_HEAP(this, oop) {
-    if (!oop->isFreeObject()
+    if (is_accessible(oop)
         &&   oop->isCompiledMethod()
         &&   oop->primitiveIndex() == Squeak_Interpreter::PrimitiveExternalCallIndex)
       oop->flushExternalPrimitive();
@@ -147,7 +183,7 @@ void Multicore_Object_Heap::snapshotCleanUp() {
 
 
 
-void Multicore_Object_Heap::write_image_file(FILE* f, u_int32* address_offsets, bool& is_first_object) {
+void Multicore_Object_Heap::write_image_file(Snapshot_Output* out, u_int32* address_offsets, bool& is_first_object) {
   
 
   const oop_int_t preheader_placeholder = Object::make_free_object_header(preheader_byte_size);
@@ -166,38 +202,37 @@ void Multicore_Object_Heap::write_image_file(FILE* f, u_int32* address_offsets,
       int bytes = obj->sizeOfFree();
       oop_int_t* p = obj->as_oop_int_p();
       for (int i = 0;  i < bytes;  i += sizeof(int32))
-        The_Memory_System()->putLong(*p++, f);
+        out->put_long(*p++);
       last_obj = obj;
       continue;
     }
 
-    assert(sizeof(long) == sizeof(Oop));
+    assert(sizeof(int32) == sizeof(Oop));
     if (preheader_oop_size  &&  !is_first_object /* see long comment above */) { // Squeak 64-bit VM bug workaround
-      The_Memory_System()->putLong(preheader_placeholder, f);
+      out->put_long(preheader_placeholder);
       for (int i = 1;  i  <  preheader_oop_size;  ++i)
-        The_Memory_System()->putLong(Oop::Illegals::free_extra_preheader_words, f);
+        out->put_long(Oop::Illegals::free_extra_preheader_words);
     }
 
     if (obj->contains_sizeHeader())
-      The_Memory_System()->putLong(obj->sizeHeader(), f);
+      out->put_long(obj->sizeHeader());
 
     if (obj->contains_class_and_type_word())
-      The_Memory_System()->putLong(
+      out->put_long(
               Header_Type::extract_from( obj->class_and_type_word() )
-              |  Header_Type::without_type( The_Memory_System()->adjust_for_snapshot(obj->get_class_oop().as_object(), address_offsets) ),
-              f);
-    The_Memory_System()->putLong(obj->baseHeader, f);
+              |  Header_Type::without_type( The_Memory_System()->adjust_for_snapshot(obj->get_class_oop().as_object(), address_offsets) ));
+    out->put_long(obj->baseHeader);
 
     oop_int_t* p;
     for ( p = &obj->baseHeader + 1;
          (Oop*)p <= obj->last_pointer_addr();
          ++p ) {
        Oop oop = *(Oop*)p;
-       The_Memory_System()->putLong( oop.is_int()
+       out->put_long( oop.is_int()
             ? oop.bits()
-            : The_Memory_System()->adjust_for_snapshot(oop.as_object(), address_offsets),  f);
+            : The_Memory_System()->adjust_for_snapshot(oop.as_object(), address_offsets));
     }
-    for (Chunk* next = obj->nextChunk();  p < (oop_int_t*)next;  The_Memory_System()->putLong(*p++, f))
+    for (Chunk* next = obj->nextChunk();  p < (oop_int_t*)next;  out->put_long(*p++))
       ; // bytes
     last_obj = obj;
     
@@ -235,7 +270,8 @@ void Multicore_Object_Heap::restore_from_checkpoint(FILE* f) {
   lastHash = lcl.lastHash;
   if (_start != lcl._start) fatal("_start mismatch");
   _next = lcl._next;
-  if (_end != lcl._end) fatal("_end mismatch");
+  if (_end_of_reservation != lcl._end_of_reservation) fatal("_end_of_reservation mismatch");
+  _end = lcl._end; // may have grown or shrunk
   xfread(_start, sizeof(*_start), lcl._next - lcl._start, f);
 
   allocationsSinceLastQuery = lcl.allocationsSinceLastQuery;
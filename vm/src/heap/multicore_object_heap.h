@@ -14,6 +14,7 @@
 
 class Multicore_Object_Heap: public Abstract_Object_Heap {
   int lastHash;
+  Nursery* nursery; // NULL unless this is a read_write heap and nurseries are on
 
   public:
   void* operator new(size_t size);
@@ -29,6 +30,8 @@ class Multicore_Object_Heap: public Abstract_Object_Heap {
 
   inline int32 newObjectHash();
   void set_lastHash(int x) { lastHash = x; }
+  Nursery* get_nursery() { return nursery; }
+  void create_nursery(int nursery_bytes);
   int  get_lastHash() { return lastHash; }
   inline Object_p allocate(oop_int_t byteSize, oop_int_t hdrSize,
                           oop_int_t baseHeader, Oop classOop, oop_int_t extendedSize, bool doFill = false,
@@ -36,6 +39,18 @@ class Multicore_Object_Heap: public Abstract_Object_Heap {
   inline Chunk* allocateChunk_for_a_new_object(oop_int_t total_bytes);
   inline Chunk* allocateChunk_for_a_new_object_and_safepoint_if_needed(int total_bytes);
 
+  // With Memory_System::tlab_KB, a core allocating into another core's heap (see coreWithSufficientSpaceToAllocate)
+  // takes a buffer from it with one atomic bump instead of stopping everyone for each object.
+  // The unused part of a buffer is always a free chunk, so the heap stays walkable.
+  private:
+  struct TLAB { Oop* next; Oop* end; };
+  TLAB tlabs[Max_Number_Of_Cores]; // threadsafe: each core only uses its own, the owner retires them all in a GC
+  bool refill_tlab(oop_int_t total_bytes);
+  public:
+  inline bool tlab_has_room_for(oop_int_t total_bytes);
+  inline Chunk* allocate_in_tlab(oop_int_t total_bytes);
+  void retire_tlabs();
+
   void add_object_from_snapshot(Oop, Object*, Object*);
   void flushExternalPrimitives();
   void handle_low_space_signal();
@@ -45,7 +60,7 @@ class Multicore_Object_Heap: public Abstract_Object_Heap {
   Oop next_instance_of_after(Oop, Oop);
 
   void snapshotCleanUp();
-  void write_image_file(FILE*, u_int32*, bool&);
+  void write_image_file(Snapshot_Output*, u_int32*, bool&);
 
   Object_p object_address_unchecked(Oop);
 
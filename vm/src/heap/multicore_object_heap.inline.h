@@ -56,7 +56,7 @@ inline Object_p Multicore_Object_Heap::allocate(oop_int_t byteSize, oop_int_t hd
   Safepoint_Ability sa(false); // from here on, no GCs!
   
   Oop remappedClassOop = hdrSize > 1  ?  The_Squeak_Interpreter()->popRemappableOop() : Oop::from_int(0);
-  Chunk* saved_next = !check_assertions ? NULL : (Chunk*) chunk->my_heap()->end_objects();
+  Chunk* saved_next = !check_assertions ? NULL : (Chunk*)((char*)chunk + total_bytes); // not the end of the heap if from a free list
   Object_p newObj = chunk->fill_in_after_allocate(byteSize, hdrSize, baseHeader,
                                                  remappedClassOop, extendedSize, doFill, fillWithNil);
   assert_eq(newObj->nextChunk(), saved_next, "allocate bug: did not set header of new oop correctly");
@@ -68,8 +68,13 @@ inline Object_p Multicore_Object_Heap::allocate(oop_int_t byteSize, oop_int_t hd
 
 inline Chunk* Multicore_Object_Heap::allocateChunk_for_a_new_object_and_safepoint_if_needed(int total_bytes) {
   Safepoint_for_moving_objects* sp = NULL;
-  if (The_Memory_System()->rank_for_address(_next) != Logical_Core::my_rank()) 
+  if (The_Memory_System()->rank_for_address(_next) != Logical_Core::my_rank()) {
+    if (Memory_System::is_using_tlabs()) {
+      Chunk* c = allocate_in_tlab(total_bytes);
+      if (c != NULL)  return c;
+    }
     sp = new Safepoint_for_moving_objects("inter-core allocate");
+  }
 
   Chunk* chunk = allocateChunk_for_a_new_object(total_bytes);
   
@@ -84,10 +89,40 @@ inline Chunk* Multicore_Object_Heap::allocateChunk_for_a_new_object(oop_int_t to
   // Since interpreter EXPECTS GC at this point (only if the SafepointAbility is able),
   // can flush objects from local to global heap,
   // or even resort to allocation in global heap.
+  if (nursery != NULL  &&  rank() == Logical_Core::my_rank()) {
+    Chunk* c = nursery->allocateChunk_for_a_new_object(total_bytes);
+    if (c != NULL)  return c;
+  }
+  if (Memory_System::borrow_space  &&  rank() == Logical_Core::my_rank()  &&  !has_room_without_gc(total_bytes)) {
+    Chunk* c = The_Memory_System()->borrow_chunk_for_a_new_object(total_bytes);
+    if (c != NULL)  return c;
+  }
   return allocateChunk(total_bytes);
 }
 
 
+// an exact fit, or room for the free chunk left over
+inline bool Multicore_Object_Heap::tlab_has_room_for(oop_int_t total_bytes) {
+  TLAB* t = &tlabs[Logical_Core::my_rank()];
+  u_int32 left = (char*)t->end - (char*)t->next;
+  return left == u_int32(total_bytes)  ||  left >= u_int32(total_bytes + Free_Chunk_Lists::min_free_bytes);
+}
+
+
+inline Chunk* Multicore_Object_Heap::allocate_in_tlab(oop_int_t total_bytes) {
+  if (!tlab_has_room_for(total_bytes)  &&  !refill_tlab(total_bytes))
+    return NULL;
+  TLAB* t = &tlabs[Logical_Core::my_rank()];
+  Chunk* r = (Chunk*)t->next;
+  t->next = (Oop*)((char*)r + total_bytes);
+  if (t->next < t->end)
+    ((Chunk*)t->next)->set_free_object_header((char*)t->end - (char*)t->next);
+  if (check_assertions)
+    oopset_no_store_check((Oop*)r, Oop::from_bits(Oop::Illegals::allocated), total_bytes/sizeof(Oop));
+  return r;
+}
+
+
 inline int32 Multicore_Object_Heap::newObjectHash() {
   // "Answer a new 16-bit pseudo-random number for use as an identity hash."
   return lastHash = (13849 + (27181 * (lastHash + Logical_Core::my_rank()))) & 65535;
@@ -20,7 +20,7 @@ bool Multicore_Object_Table::replicate = false  &&  !Omit_Duplicated_OT_Overhead
 Multicore_Object_Table::Entry* Multicore_Object_Table::Segment::construct_free_list() {
   Entry* r = NULL;
   for (int i = n - 1;  i >= 0;  --i) {
-    words[i].i = oop_int_t(r);
+    words[i].i = entry_int_t(r);
     r = Entry::from_word_addr(&words[i]);
   }
   return r;
@@ -31,11 +31,18 @@ Multicore_Object_Table::Multicore_Object_Table() : Abstract_Object_Table() {
   FOR_ALL_RANKS(i) {
     first_segment[i] = NULL;
     first_free_entry[i] = NULL;
+    free_entry_count[i] = 0;
     lowest_address[i] = (void*)~0;
     lowest_address_after_me[i] = NULL;
     allocatedEntryCount[i] = entryCount[i] = allocationsSinceLastQuery[i] = entriesFreedSinceLastQuery[i] = 0;
   }
-  Entry::verify_from_oop_optimization();
+  first_spare_entry = NULL;
+  spare_entry_count = 0;
+  OS_Interface::mutex_init(&spare_entries_lock);
+  free_segment_count = emptied_segment_count = 0;
+  OS_Interface::mutex_init(&free_segments_lock);
+  if (!Omit_Object_Table) Entry::verify_from_oop_optimization(); // else oops are addresses, and the entries go unused
+  if (Compressed_Oops) reserve_compressed_oop_range();
   OS_Interface::abort_if_error("Segment heap creation", OS_Interface::mem_create_heap_if_on_Tilera(&heap, replicate));
 }
 
@@ -54,6 +61,7 @@ void Multicore_Object_Table::update_segment_list(Segment* s, int rank  COMMA_DCL
 
 void Multicore_Object_Table::update_free_list(Segment* s, int rank) {
   first_free_entry[rank] = s->construct_free_list();
+  free_entry_count[rank] = Segment::n;
   entryCount[rank] += Segment::n;
 }
 
@@ -64,20 +72,251 @@ Multicore_Object_Table::Segment::Segment(Multicore_Object_Table* mot, int rank
     mot->update_bounds(this, rank);
     mot->update_segment_list(this, rank  COMMA_USE_ESB);
     mot->update_free_list(this, rank);
+    // the core allocating may not be the one with this rank, e.g. when reading the snapshot
+    if (Memory_System::home_to_numa_nodes)
+      OS_Interface::home_memory_to_core(this, alignment_and_size, rank);
+  }
+}
+
+char* Multicore_Object_Table::Segment::arena_next[Max_Number_Of_Cores];
+char* Multicore_Object_Table::Segment::arena_end [Max_Number_Of_Cores];
+
+void* Multicore_Object_Table::Segment::allocate_from_arena() {
+  const int my_rank = Logical_Core::my_rank();
+  if (arena_next[my_rank] >= arena_end[my_rank]) {
+    arena_next[my_rank] = OS_Interface::map_memory_for_transparent_huge_pages(Memory_System::transparent_huge_page_size,
+                                                                              Memory_System::transparent_huge_page_size);
+    arena_end[my_rank] = arena_next[my_rank] + Memory_System::transparent_huge_page_size;
+  }
+  void* p = arena_next[my_rank];
+  arena_next[my_rank] += alignment_and_size;
+  return p;
+}
+
+char* Multicore_Object_Table::compressed_oop_range_start = NULL;
+char* Multicore_Object_Table::compressed_oop_range_next  = NULL;
+char* Multicore_Object_Table::compressed_oop_range_end   = NULL;
+
+void Multicore_Object_Table::reserve_compressed_oop_range() {
+  if (compressed_oop_range_start != NULL)  return;
+  // oops carry the entry index above the tag bits
+  const size_t bytes = (size_t(1) << (sizeof(oop_int_t) * 8 - Header_Type::Width)) * sizeof(word_union);
+  compressed_oop_range_start = compressed_oop_range_next = OS_Interface::reserve_memory(bytes); // page aligned
+  compressed_oop_range_end   = compressed_oop_range_start + bytes;
+}
+
+void* Multicore_Object_Table::Segment::allocate_from_compressed_oop_range() {
+  // any core may add a segment, so claim it with a CAS rather than a lock
+  for (;;) {
+    char* p = compressed_oop_range_next;
+    if (p + alignment_and_size > compressed_oop_range_end)
+      return NULL;
+    if (OS_Interface::atomic_compare_and_swap((void**)&compressed_oop_range_next, p, p + alignment_and_size))
+      return p;
   }
 }
 
 void* Multicore_Object_Table::Segment::operator new(size_t /* s */) {
-  void* p = OS_Interface::rvm_memalign_shared(The_Memory_System()->object_table->heap, alignment_and_size, sizeof(Segment));
+  void* p = The_Memory_System()->object_table->take_free_segment();
+  if (p == NULL)
+    p = Compressed_Oops
+    ? allocate_from_compressed_oop_range()
+    : Memory_System::use_transparent_huge_pages  &&  Using_Threads
+    ? allocate_from_arena()
+    : OS_Interface::rvm_memalign_shared(The_Memory_System()->object_table->heap, alignment_and_size, sizeof(Segment));
   assert(sizeof(Segment) <= alignment_and_size);
   if (p == NULL) fatal("OT Segment allocation");
-  // xxxxxx Should home segments appropriately someday.
+  // homed in the constructor, once the rank is known
   if (!The_Squeak_Interpreter()->use_checkpoint()) bzero(p, sizeof(Segment));
   return p;
 }
 
 
 
+// Splices up to a batch of spare entries onto the front of the list of rank.
+bool Multicore_Object_Table::take_batch_of_spare_entries(int rank  COMMA_DCL_ESB) {
+  if (spare_entry_count == 0) // save the lock
+    return false;
+  OS_Interface::mutex_lock(&spare_entries_lock);
+  Entry* first = first_spare_entry;
+  Entry* last = NULL;
+  u_int32 n = 0;
+  for (Entry* e = first;  e != NULL  &&  n < entries_per_batch;  e = e->word()->get_entry(), ++n)
+    last = e;
+  if (n > 0) {
+    first_spare_entry = last->word()->get_entry();
+    spare_entry_count -= n;
+  }
+  OS_Interface::mutex_unlock(&spare_entries_lock);
+  if (n == 0)
+    return false;
+
+  last->word()->set_entry(first_free_entry[rank]  COMMA_USE_ESB);
+  first_free_entry[rank] = first;
+  free_entry_count[rank] += n;
+  return true;
+}
+
+
+// Keeps batches_to_keep batches, the rest goes to the spare entries in one splice.
+void Multicore_Object_Table::give_back_surplus_entries(int rank  COMMA_DCL_ESB) {
+  const u_int32 keep = batches_to_keep * entries_per_batch;
+  if (free_entry_count[rank] <= keep)
+    return;
+  Entry* last_kept = first_free_entry[rank];
+  for (u_int32 i = 1;  i < keep;  ++i)
+    last_kept = last_kept->word()->get_entry();
+  Entry* first_surplus = last_kept->word()->get_entry();
+  Entry* last_surplus = first_surplus;
+  while (last_surplus->word()->get_entry() != NULL)
+    last_surplus = last_surplus->word()->get_entry();
+  last_kept->word()->set_entry(NULL  COMMA_USE_ESB);
+
+  OS_Interface::mutex_lock(&spare_entries_lock);
+  last_surplus->word()->set_entry(first_spare_entry  COMMA_USE_ESB);
+  first_spare_entry = first_surplus;
+  spare_entry_count += free_entry_count[rank] - keep;
+  OS_Interface::mutex_unlock(&spare_entries_lock);
+
+  free_entry_count[rank] = keep;
+}
+
+
+// The entries of the dead objects end up on the lists of the cores that swept them,
+// which need not be the cores that will allocate the most; so even things out after a GC.
+void Multicore_Object_Table::rebalance_free_entries() {
+  FOR_ALL_RANKS(r)
+    give_back_surplus_entries(r  COMMA_FALSE_OR_NOTHING);
+  FOR_ALL_RANKS(r)
+    if (free_entry_count[r] < entries_per_batch)
+      take_batch_of_spare_entries(r  COMMA_FALSE_OR_NOTHING);
+}
+
+
+Multicore_Object_Table::Segment* Multicore_Object_Table::take_free_segment() {
+  if (free_segment_count == 0) // save the lock
+    return NULL;
+  OS_Interface::mutex_lock(&free_segments_lock);
+  Segment* s = free_segment_count == 0  ?  NULL  :  free_segments[--free_segment_count];
+  OS_Interface::mutex_unlock(&free_segments_lock);
+  return s;
+}
+
+
+// Whether few enough entries are in use that emptying segments would pay.
+bool Multicore_Object_Table::is_sparse(int occupancy_percent) {
+  u_int64 used = 0,  all = 0;
+  FOR_ALL_RANKS(r) {
+    used += allocatedEntryCount[r];
+    all  += entryCount[r];
+  }
+  return all > u_int64(Segment::n) * Logical_Core::group_size  &&  used * 100  <  all * occupancy_percent;
+}
+
+
+int Multicore_Object_Table::Segment::count_used_entries() {
+  int c = 0;
+  for (Entry* e = first_entry();  e < end_entry();  e = e->next())
+    if (e->is_used()) ++c;
+  return c;
+}
+
+// Backwards, so that the list runs up through memory
+void Multicore_Object_Table::Segment::add_free_entries_to_free_list(Multicore_Object_Table* ot, int rank) {
+  for (Entry* e = last_entry();  e >= first_entry();  e = e->prev())
+    if (!e->is_used()) {
+      e->word()->set_obj_and_spare_bit(NULL, false  COMMA_FALSE_OR_NOTHING);
+      ot->add_entry_to_free_list(e, rank  COMMA_FALSE_OR_NOTHING);
+    }
+}
+
+// The old entry keeps pointing at the object till the references have been forwarded to the new one.
+void Multicore_Object_Table::Segment::move_used_entries(Multicore_Object_Table* ot) {
+  for (Entry* e = first_entry();  e < end_entry();  e = e->next())
+    if (e->is_used()) {
+      Oop new_oop = ot->allocate_oop(rank()  COMMA_FALSE_OR_NOTHING);
+      ot->word_for(new_oop)->set(e->word()->i  COMMA_FALSE_OR_NOTHING); // object and spare bit
+      e->word()->obj()->set_forwarding_backpointer(new_oop);
+    }
+}
+
+
+struct Segment_and_used_count {
+  void* segment;
+  int used;
+  static int compare(const void* a, const void* b) {
+    return ((Segment_and_used_count*)a)->used - ((Segment_and_used_count*)b)->used;
+  }
+};
+
+// Called in a GC, after the sweep: renumbers the oops in each rank's sparsest segments into the free entries
+// of its others, leaving the backpointers of the moved objects at their new oops for Memory_System::forward_all_references.
+// Each rank keeps enough segments for its used entries plus batches_to_keep batches of free ones.
+// Since the free lists are rebuilt from the kept segments, they end up in address order, too.
+int Multicore_Object_Table::empty_sparsest_segments() {
+  first_spare_entry = NULL;
+  spare_entry_count = 0;
+  FOR_ALL_RANKS(r) {
+    first_free_entry[r] = NULL;
+    free_entry_count[r] = 0;
+  }
+  emptied_segment_count = 0;
+  FOR_ALL_RANKS(r) {
+    int n_segs = 0;
+    for (Segment* s = first_segment[r];  s != NULL;  s = s->next())
+      ++n_segs;
+    if (n_segs == 0)
+      continue;
+    Segment_and_used_count* segs = (Segment_and_used_count*)malloc(n_segs * sizeof(Segment_and_used_count));
+    int used = 0,  i = 0;
+    for (Segment* s = first_segment[r];  s != NULL;  s = s->next(), ++i) {
+      segs[i].segment = s;
+      segs[i].used = s->count_used_entries();
+      used += segs[i].used;
+    }
+    int n_to_keep = divide_and_round_up(used + int(batches_to_keep * entries_per_batch), Segment::n);
+    int n_to_empty = min(n_segs - n_to_keep,  max_free_segments - free_segment_count - emptied_segment_count);
+    if (n_to_empty > 0)
+      qsort(segs, n_segs, sizeof(Segment_and_used_count), Segment_and_used_count::compare);
+    else
+      n_to_empty = 0;
+
+    for (i = n_segs - 1;  i >= n_to_empty;  --i)
+      ((Segment*)segs[i].segment)->add_free_entries_to_free_list(this, r);
+    for (i = 0;  i < n_to_empty;  ++i)
+      free_segments[free_segment_count + emptied_segment_count++] = (Segment*)segs[i].segment;
+    free(segs);
+  }
+  for (int i = 0;  i < emptied_segment_count;  ++i)
+    free_segments[free_segment_count + i]->move_used_entries(this);
+  return emptied_segment_count;
+}
+
+
+// Once nothing refers to the old oops any more
+void Multicore_Object_Table::release_emptied_segments() {
+  for (int i = 0;  i < emptied_segment_count;  ++i) {
+    Segment* s = free_segments[free_segment_count + i];
+    entryCount[s->rank()] -= Segment::n;
+    s->mark_emptied();
+  }
+  FOR_ALL_RANKS(r) {
+    Segment* s = first_segment[r];
+    first_segment[r] = NULL;
+    while (s != NULL) {
+      Segment* next = s->next();
+      if (!s->is_emptied())
+        update_segment_list(s, r  COMMA_FALSE_OR_NOTHING);
+      s = next;
+    }
+  }
+  for (int i = 0;  i < emptied_segment_count;  ++i)
+    OS_Interface::release_heap_memory(free_segments[free_segment_count + i], sizeof(Segment));
+  free_segment_count += emptied_segment_count;
+  emptied_segment_count = 0;
+}
+
+
 bool Multicore_Object_Table::is_on_free_list(Entry* e, int rank) {
   for (Entry* ee = first_free_entry[rank];  ee;  ee = ee->word()->get_entry())
     if (ee == e)
@@ -85,7 +324,22 @@ bool Multicore_Object_Table::is_on_free_list(Entry* e, int rank) {
   return false;
 }
 
-bool Multicore_Object_Table::is_OTE_free(Oop x) { return !The_Memory_System()->contains(word_for(x)->obj()); }
+bool Multicore_Object_Table::is_OTE_free(Oop x) {
+  if (Omit_Object_Table) return x.as_object()->isFreeObject();
+  return !The_Memory_System()->contains(word_for(x)->obj());
+}
+
+
+// Free entries point into other segments, used ones into the heaps.
+void Multicore_Object_Table::free_entries_of_unmarked_objects() {
+  FOR_ALL_RANKS(r)
+    for (Segment* s = first_segment[r];  s != NULL;  s = s->next())
+      for (Entry* e = s->first_entry();  e < s->end_entry();  e = e->next()) {
+        Object* obj = e->word()->obj();
+        if (The_Memory_System()->contains(obj)  &&  !obj->is_marked())
+          free_oop(e->oop()  COMMA_FALSE_OR_NOTHING);
+      }
+}
 
 
 bool Multicore_Object_Table::verify_entry_address(Entry* e) {
@@ -106,6 +360,8 @@ bool Multicore_Object_Table::verify_after_mark() {
 
 bool Multicore_Object_Table::verify_all_free_lists() {
   FOR_ALL_RANKS(r) verify_free_list(r);
+  for (Entry* e = first_spare_entry;  e != NULL;  e = e->word()->get_entry())
+    e->verify_free_entry(this);
   return true;
 }
 
@@ -158,7 +414,8 @@ bool Multicore_Object_Table::Entry::verify_used_entry(bool live_ones_are_marked)
   Object* obj = word()->obj();
   if (obj != NULL) {
     assert_always(The_Memory_System()->contains(obj));
-    assert_always(!obj->is_marked() || live_ones_are_marked);
+    assert_always(!obj->is_marked() || live_ones_are_marked  ||  The_Memory_System()->is_marking_concurrently()
+                  ||  The_Memory_System()->space_containing(obj)->is_unswept(obj));
   }
   else
     fatal("no addr");
@@ -269,7 +526,7 @@ void Multicore_Object_Table::word_union::post_cohere_OTE() {
 void Multicore_Object_Table::print() {
   FOR_ALL_RANKS(r) {
     lprintf("Multicore_Object_Table: rank %d,  ", r);
-    lprintf("first_segment 0x%x, first_free_entry 0x%x, allocatedEntryCount %d, entryCount %d, allocationsSinceLastQuery %d, entriesFreedSinceLastQuery %d, lowest_address 0x%x, lowest_address_after_me 0x%x\n",
+    lprintf("first_segment %p, first_free_entry %p, allocatedEntryCount %d, entryCount %d, allocationsSinceLastQuery %d, entriesFreedSinceLastQuery %d, lowest_address %p, lowest_address_after_me %p\n",
      first_segment[r], first_free_entry[r], allocatedEntryCount[r], entryCount[r], allocationsSinceLastQuery[r], entriesFreedSinceLastQuery[r], lowest_address[r], lowest_address_after_me[r]);
      for (Segment* s = first_segment[r];  s != NULL;  s = s->next())
        s->print();
@@ -287,12 +544,12 @@ void Multicore_Object_Table::Segment::set_next(Segment* s  COMMA_DCL_ESB) {
 }
 
 void Multicore_Object_Table::Segment::print() {
-  lprintf("\tSegment: first_entry 0x%x, end_entry 0x%x\n", first_entry(), end_entry());
+  lprintf("\tSegment: first_entry %p, end_entry %p\n", first_entry(), end_entry());
 }
 
 
 void Multicore_Object_Table::check_for_debugging(Oop x) {
-  if (!probably_contains((void*)x.bits())) {
+  if (!probably_contains(Entry::from_oop(x))) {
     lprintf("object_for caught one\n");
     fatal("caught it");
   }
@@ -17,22 +17,23 @@ class Multicore_Object_Table: public Abstract_Object_Table {
    static bool replicate;
  private:
   class Entry;
-  static const int bit_mask = 3;
-  static const int obj_mask = ~bit_mask;
-  static const int spare_bit = 1;
+  typedef intptr_t entry_int_t; // an entry holds a whole Object*, even where an oop is narrower
+  static const entry_int_t bit_mask = 3;
+  static const entry_int_t obj_mask = ~bit_mask;
+  static const entry_int_t spare_bit = 1;
   union word_union {
 # if Extra_OTE_Words_for_Debugging_Block_Context_Method_Change_Bug
     struct { oop_int_t x, y, z, t; };
 # endif
-    oop_int_t i;
+    entry_int_t i;
     Entry* _e;
     Entry* get_entry() { return _e; }
-    void set_entry(Entry* e COMMA_DCL_ESB) { set(oop_int_t(e)  COMMA_USE_ESB); }// async
+    void set_entry(Entry* e COMMA_DCL_ESB) { set(entry_int_t(e)  COMMA_USE_ESB); }// async
 
     Object* obj() { return (Object*)(i & obj_mask); }
         
     void set_obj(Object* x  COMMA_DCL_ESB)  {
-      set(((oop_int_t)x & obj_mask)  |  (i & bit_mask)  COMMA_USE_ESB);
+      set(((entry_int_t)x & obj_mask)  |  (i & bit_mask)  COMMA_USE_ESB);
     }
     int bits() {  return i & bit_mask; }
     void set_bits(int x  COMMA_DCL_ESB) { set((i & obj_mask)  |  (x & bit_mask)  COMMA_USE_ESB); }
@@ -45,9 +46,9 @@ class Multicore_Object_Table: public Abstract_Object_Table {
       else    set(i & ~spare_bit  COMMA_USE_ESB);
     }
     void set_obj_and_spare_bit(Object* obj,  bool spare  COMMA_DCL_ESB) {
-      set((oop_int_t(obj) & ~bit_mask)  |  (spare ? spare_bit : 0)  COMMA_USE_ESB);
+      set((entry_int_t(obj) & ~bit_mask)  |  (spare ? spare_bit : 0)  COMMA_USE_ESB);
     }
-    void set(oop_int_t x  COMMA_DCL_ESB) {
+    void set(entry_int_t x  COMMA_DCL_ESB) {
       if (!ESB_OR_FALSE  ||  !replicate) i = x;
       else { pre_cohere_OTE();  i = x;  post_cohere_OTE(); }
     }
@@ -68,7 +69,9 @@ class Multicore_Object_Table: public Abstract_Object_Table {
   public:
     Segment* next() { return h._next; }
     int rank() { return h._rank; }
-    static Segment* enclosing(void* p) { return (Segment*) ( int(p) & ~(alignment_and_size - 1)); }
+    void mark_emptied() { h._rank = -1; }
+    bool is_emptied() { return h._rank < 0; }
+    static Segment* enclosing(void* p) { return (Segment*) ( intptr_t(p) & ~intptr_t(alignment_and_size - 1)); }
     void set_next(Segment* s  COMMA_DCL_ESB);
     static const int n = (alignment_and_size - sizeof(header)) / sizeof(word_union);
     // parallel arrays to optimize caching, system uses word shift, see bits_for_hash in oop.h
@@ -76,11 +79,21 @@ class Multicore_Object_Table: public Abstract_Object_Table {
 
     void* operator new(size_t);
     Segment(Multicore_Object_Table*,int  COMMA_DCL_ESB);
+  private:
+    // With Memory_System::use_transparent_huge_pages, segments are carved out of huge-page-aligned arenas
+    static char* arena_next[Max_Number_Of_Cores]; // threadsafe: each core only uses its own
+    static char* arena_end [Max_Number_Of_Cores];
+    static void* allocate_from_arena();
+    static void* allocate_from_compressed_oop_range();
+  public:
     Entry* construct_free_list();
     Entry*   end_entry() { return Entry::from_word_addr(&words[n]); }
     Entry*  last_entry() { return Entry::from_word_addr(&words[n-1]); }
     Entry* first_entry() { return Entry::from_word_addr(&words[0]); }
     bool contains_entry(Entry* e) { return first_entry() <= e  &&  e < end_entry(); }
+    int count_used_entries();
+    void add_free_entries_to_free_list(Multicore_Object_Table*, int);
+    void move_used_entries(Multicore_Object_Table*);
 
     bool verify(Multicore_Object_Table*, bool);
 
@@ -92,15 +105,23 @@ class Multicore_Object_Table: public Abstract_Object_Table {
   public:
     static Entry* from_word_addr(word_union* x) { return (Entry*)x; }
     word_union* word() { return (word_union*)this; }
-    oop_int_t mem_bits() { return (oop_int_t)this / sizeof(Object*); }
+# if Compressed_Oops
+    // the oop is the index of the entry in the reserved range, the first segment header keeps index 0 unused
+    oop_int_t mem_bits() { return ((char*)this - compressed_oop_range_start) / sizeof(word_union); }
+    static Entry* from_mem_bits(oop_int_t x) { return (Entry*)(compressed_oop_range_start + u_oop_int_t(x) * sizeof(word_union)); }
+    static Entry* from_oop(Oop x) { return from_mem_bits(x.mem_bits()); }
+    static bool verify_from_oop_optimization() { return true; }
+# else
+    oop_int_t mem_bits() { return oop_int_t(intptr_t(this) / sizeof(Object*)); }
     static Entry* from_mem_bits(oop_int_t x) { return (Entry*)(x * sizeof(Object*)); }
     static Entry* from_oop(Oop x) {
-      return /*from_mem_bits(x.mem_bits())*/ (Entry*)x.bits();
+      return /*from_mem_bits(x.mem_bits())*/ (Entry*)intptr_t(x.bits());
     }
     static bool verify_from_oop_optimization() {
-      assert_always((int)from_mem_bits(Oop::from_bits(Oop::Illegals::magic).mem_bits()) == Oop::Illegals::magic);
+      assert_always((int)(intptr_t)from_mem_bits(Oop::from_bits(Oop::Illegals::magic).mem_bits()) == Oop::Illegals::magic);
       return true;
     }
+# endif
     Entry* prev() { return from_word_addr(word() - 1); }
     Entry* next() { return from_word_addr(word() + 1); }
     Oop oop() { return Oop::from_mem_bits(mem_bits()); }
@@ -117,10 +138,37 @@ class Multicore_Object_Table: public Abstract_Object_Table {
 
   OS_Interface::OS_Heap heap;
 
+  // With Compressed_Oops, all segments live in one reserved range so that an oop can be a 32-bit index
+  static char* compressed_oop_range_start;
+  static char* compressed_oop_range_next;
+  static char* compressed_oop_range_end;
+  static void reserve_compressed_oop_range();
+
   Segment* first_segment[Max_Number_Of_Cores];
+  // Each core allocates from and frees to its own list, whichever segment the entries are in.
   Entry* first_free_entry[Max_Number_Of_Cores];
-
-  u_int32 allocatedEntryCount[Max_Number_Of_Cores];
+  u_int32 free_entry_count[Max_Number_Of_Cores];
+
+  // A core that runs out takes a batch from the spare entries before making a new segment,
+  // and a core with a surplus after a GC gives it back, see rebalance_free_entries.
+  static const u_int32 entries_per_batch = 256;
+  static const u_int32 batches_to_keep = 2;
+  OS_Interface::Mutex spare_entries_lock;
+  Entry* first_spare_entry;
+  u_int32 spare_entry_count;
+
+  // Segments emptied by empty_sparsest_segments, their pages given back to the OS; reused before making new ones.
+  // The ones just emptied follow the first free_segment_count till release_emptied_segments.
+  static const int max_free_segments = 1024;
+  OS_Interface::Mutex free_segments_lock;
+  Segment* free_segments[max_free_segments];
+  int free_segment_count;
+  int emptied_segment_count;
+  Segment* take_free_segment();
+
+  // The first two count the entries in each rank's segments, the used ones and all of them; since any core may
+  // reuse or free an entry of any segment, allocatedEntryCount changes atomically. The last two count what each core did.
+  int allocatedEntryCount[Max_Number_Of_Cores];
   u_int32 entryCount[Max_Number_Of_Cores];
   u_int32 allocationsSinceLastQuery[Max_Number_Of_Cores];
   u_int32 entriesFreedSinceLastQuery[Max_Number_Of_Cores]; // how many frees have happened
@@ -165,6 +213,7 @@ public:
     return word_for(x)->obj();
   }
   void set_object_for(Oop x, Object_p obj  COMMA_DCL_ESB) {
+    if (Omit_Object_Table) return; // the references are fixed up instead, see Memory_System::forward_moved_objects
     word_for(x)->set_obj(obj  COMMA_USE_ESB);
   }
 
@@ -173,15 +222,22 @@ public:
 
 
   void free_oop(Oop x  COMMA_DCL_ESB) {
+    if (Omit_Object_Table) return;
     Entry* e = entry_from_oop(x);
-    int rank = e->rank();
+    int my_rank = Logical_Core::my_rank();
     e->word()->set_obj_and_spare_bit(NULL, false  COMMA_USE_ESB);
-    add_entry_to_free_list(e, rank  COMMA_USE_ESB);
-    --allocatedEntryCount[rank];
-    ++entriesFreedSinceLastQuery[rank];
+    add_entry_to_free_list(e, my_rank  COMMA_USE_ESB);
+    OS_Interface::atomic_fetch_and_add(&allocatedEntryCount[e->rank()], -1);
+    ++entriesFreedSinceLastQuery[my_rank];
   }
 
   bool is_OTE_free(Oop x);
+  void free_entries_of_unmarked_objects();
+  void rebalance_free_entries();
+
+  bool is_sparse(int occupancy_percent);
+  int empty_sparsest_segments();
+  void release_emptied_segments();
 
 
 # if Extra_OTE_Words_for_Debugging_Block_Context_Method_Change_Bug
@@ -202,8 +258,10 @@ private:
     Entry*& first_free = first_free_entry[rank];
     e->word()->set_entry(first_free  COMMA_USE_ESB);
     first_free = e;
-    --allocatedEntryCount[rank];
+    ++free_entry_count[rank];
   }
+  bool take_batch_of_spare_entries(int rank  COMMA_DCL_ESB);
+  void give_back_surplus_entries(int rank  COMMA_DCL_ESB);
 
   Entry* entry_from_oop(Oop x) {
     Entry* e = Entry::from_oop(x);
@@ -216,8 +274,17 @@ public:
   bool verify_after_mark();
 
   inline bool probably_contains(void*) const;
+  inline bool probably_contains_oop(Oop) const;
 
   Oop get_stats(int);
+  u_int32 entries(int rank) { return entryCount[rank]; }
+  int allocated_entries(int rank) { return allocatedEntryCount[rank]; }
+  u_int32 free_entries(int rank) { return free_entry_count[rank]; }
+  u_int32 spare_entries() { return spare_entry_count; }
+  static u_int32 free_entries_to_keep() { return batches_to_keep * entries_per_batch; }
+  static u_int32 free_entries_per_batch() { return entries_per_batch; }
+  static int entries_per_segment() { return Segment::n; }
+  int reusable_segments() { return free_segment_count; }
 
 private:
   bool verify_entry_address(Entry*);
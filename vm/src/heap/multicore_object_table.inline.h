@@ -19,11 +19,13 @@ inline Oop Multicore_Object_Table::allocate_oop(int rank COMMA_DCL_ESB)  {
   Entry*& first_free = first_free_entry[rank];
   Entry* e = first_free;
   if (e == NULL) {
-    new Segment(this, rank  COMMA_USE_ESB);
+    if (!take_batch_of_spare_entries(rank  COMMA_USE_ESB))
+      new Segment(this, rank  COMMA_USE_ESB);
     e = first_free;
    }
   __attribute__((unused)) Entry* last_first_free = e; // debugging
   first_free = (Entry*)e->word()->get_entry();
+  --free_entry_count[rank];
 
   e->word()->clear_debugging_words();
 
@@ -43,10 +45,15 @@ inline int Multicore_Object_Table::rank_for_adding_object_from_snapshot(Oop x) {
 
 
 inline Oop Multicore_Object_Table::allocate_oop_and_set_backpointer(Object_p obj, int rank  COMMA_DCL_ESB) {
+  if (Omit_Object_Table) {
+    Oop r = obj->as_oop(); // its address
+    obj->set_backpointer(r);
+    return r;
+  }
   Oop r = allocate_oop(rank COMMA_USE_ESB);
   obj->set_backpointer(r); // should never be a read-mostly obj anyway
   set_object_for(r, obj  COMMA_USE_ESB);
-  ++allocatedEntryCount[rank];
+  OS_Interface::atomic_fetch_and_add(&allocatedEntryCount[entry_from_oop(r)->rank()], 1); // the entry may be from another rank's segment
   ++allocationsSinceLastQuery[rank];
   return r;
 }
@@ -73,3 +80,8 @@ inline bool Multicore_Object_Table::probably_contains(void* p) const {
   return false;
 }
 
+// Whether x looks like a valid oop; without an object table, it is the address of an object
+inline bool Multicore_Object_Table::probably_contains_oop(Oop x) const {
+  return Omit_Object_Table  ?  The_Memory_System()->contains((void*)uintptr_t(u_oop_int_t(x.bits())))  :  probably_contains(Entry::from_oop(x));
+}
+
@@ -0,0 +1,418 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+#include "headers.h"
+
+
+void Nursery::initialize_nursery(Multicore_Object_Heap* old, void* mem, int size) {
+  Abstract_Object_Heap::initialize(mem, size);
+  old_space = old;
+
+  int words = size / sizeof(Oop);
+  escaped_bits = (u_int32*)Memory_Semantics::shared_calloc(divide_and_round_up(words, 32), sizeof(u_int32));
+  have_escaped_objects = false;
+
+  remembered_set_capacity = initial_remembered_set_capacity;
+  remembered_set = (Oop*)Memory_Semantics::shared_malloc(remembered_set_capacity * sizeof(Oop));
+  clear_remembered_set();
+  objects_to_scan = new GC_Oop_Stack();
+
+  // the whole nursery is always walkable, starting out as one free chunk
+  _next = _end;
+  ((Chunk*)_start)->make_free_object((char*)_end - (char*)_start, 3);
+  gap_start = _start;
+  gap_top   = _end;
+}
+
+
+// Remembered set
+
+int Nursery::index_of_remembered(Oop x) {
+  // linear probing, passing over forgotten slots
+  int i = (x.bits() >> ShiftForWord) & (remembered_set_capacity - 1);
+  while (remembered_set[i] != x  &&  remembered_set[i] != never_used())
+    i = (i + 1) & (remembered_set_capacity - 1);
+  return i;
+}
+
+
+void Nursery::add_to_remembered_set(Oop x) {
+  int i = index_of_remembered(x);
+  if (remembered_set[i] == x)
+    return;
+  if (remembered_set_used + 1  >  remembered_set_capacity / 2) {
+    grow_remembered_set();
+    i = index_of_remembered(x);
+  }
+  remembered_set[i] = x;
+  ++remembered_set_used;
+}
+
+
+void Nursery::grow_remembered_set() {
+  int live = 0;
+  for (int i = 0;  i < remembered_set_capacity;  ++i)
+    if (remembered_set[i].is_mem())
+      ++live;
+
+  // purging the forgotten ones may be enough
+  rehash_remembered_set(live * 4  >=  remembered_set_capacity  ?  remembered_set_capacity * 2  :  remembered_set_capacity);
+}
+
+
+void Nursery::rehash_remembered_set(int new_capacity) {
+  Oop* old_set = remembered_set;
+  int old_capacity = remembered_set_capacity;
+  remembered_set_capacity = new_capacity;
+  remembered_set = (Oop*)Memory_Semantics::shared_malloc(remembered_set_capacity * sizeof(Oop));
+  clear_remembered_set();
+  for (int i = 0;  i < old_capacity;  ++i)
+    if (old_set[i].is_mem()) {
+      remembered_set[index_of_remembered(old_set[i])] = old_set[i];
+      ++remembered_set_used;
+    }
+  Memory_Semantics::shared_free(old_set);
+}
+
+
+// Called when references are forwarded, see Memory_System::forward_all_references:
+// the remembered objects may have new oops, and the set hashes on them.
+void Nursery::forward_remembered_set() {
+  for (int i = 0;  i < remembered_set_capacity;  ++i)
+    if (remembered_set[i].is_mem())
+      remembered_set[i] = remembered_set[i].as_object()->backpointer();
+  rehash_remembered_set(remembered_set_capacity);
+}
+
+
+void Nursery::forget(Oop x) {
+  int i = index_of_remembered(x);
+  if (remembered_set[i] == x)
+    remembered_set[i] = forgotten(); // still counts as used
+}
+
+
+void Nursery::clear_remembered_set() {
+  for (int i = 0;  i < remembered_set_capacity;  ++i)
+    remembered_set[i] = never_used();
+  remembered_set_used = 0;
+}
+
+
+// Called after storing into an object without the barrier, e.g. into the active context.
+void Nursery::remember(Object_p obj) {
+  if (is_private(obj))
+    return;
+  add_to_remembered_set(obj->as_oop());
+}
+
+
+// Publishing scans what it forgets, but the interpreter keeps storing into these.
+void Nursery::remember_interpreter_contexts() {
+  Squeak_Interpreter* const interp = The_Squeak_Interpreter();
+  if (!interp->process_is_scheduled_and_executing())
+    return;
+  if (!is_private(interp->activeContext_obj()))    add_to_remembered_set(interp->activeContext());
+  if (!is_private(interp->theHomeContext_obj()))   add_to_remembered_set(interp->theHomeContext());
+}
+
+
+void Nursery::forget_unmarked_remembered_objects() {
+  for (int i = 0;  i < remembered_set_capacity;  ++i)
+    if (remembered_set[i].is_mem()  &&  !remembered_set[i].as_object()->is_marked())
+      remembered_set[i] = forgotten();
+}
+
+
+// Escaping
+
+void Nursery::set_escaped(Object* obj) {
+  have_escaped_objects = true;
+  for (Oop* p = (Oop*)obj->my_chunk();  p < (Oop*)obj->nextChunk();  ++p) {
+    int i = p - startOfMemory();
+    escaped_bits[i >> 5] |= 1 << (i & 31);
+  }
+}
+
+
+void Nursery::clear_escaped(Chunk* from, Chunk* to) {
+  for (Oop* p = (Oop*)from;  p < (Oop*)to;  ++p) {
+    int i = p - startOfMemory();
+    escaped_bits[i >> 5] &= ~(1 << (i & 31));
+  }
+}
+
+
+// Make x, and everything young it can reach, safe for other cores to see.
+void Nursery::publish(Oop x) {
+  if (!x.is_mem())
+    return;
+  Object* obj = x.as_object();
+  if (is_private(obj))
+    set_escaped(obj);
+  else if (is_remembered(x))
+    forget(x);
+  else
+    return;
+  objects_to_scan->push(obj);
+  while (!objects_to_scan->is_empty())
+    scan_fields(objects_to_scan->pop(), &Nursery::escape_or_scan_later);
+  remember_interpreter_contexts();
+}
+
+
+void Nursery::escape_or_scan_later(Oop x) {
+  if (!x.is_mem())
+    return;
+  Object* obj = x.as_object();
+  if (is_private(obj))
+    set_escaped(obj);
+  else if (is_remembered(x))
+    forget(x);
+  else
+    return;
+  objects_to_scan->push(obj);
+}
+
+
+void Nursery::scan_fields(Object* obj, void (Nursery::*f)(Oop)) {
+  FOR_EACH_OOP_IN_OBJECT_EXCEPT_CLASS(obj, oopp)
+    (this->*f)(*oopp);
+  if (obj->contains_class_and_type_word())
+    (this->*f)(obj->get_class_oop());
+}
+
+
+// Scavenging
+
+class Promote_Closure: public Oop_Closure {
+  Nursery* nursery;
+ public:
+  Promote_Closure(Nursery* n) : Oop_Closure() { nursery = n; }
+  void value(Oop* p, Object_p) { nursery->promote_or_scan_later(*p); }
+  virtual const char* class_name(char*) { return "Promote_Closure"; }
+};
+
+
+void Nursery::scavenge(const char* why) {
+  Squeak_Interpreter* const interp = The_Squeak_Interpreter();
+  // Everything might survive, so make sure there will be room for it.
+  if (!has_room_in_old_space_for((char*)end_of_space() - (char*)startOfMemory()))
+    return;
+  if (check_many_assertions)
+    lprintf("scavenging on %d because %s\n", Logical_Core::my_rank(), why);
+
+  u_int32 start = interp->ioWhicheverMSecs();
+  Safepoint_Ability sa(false);
+  // without an image, e.g. in the unit tests, the remembered set holds the only roots
+  const bool interpreting = interp->is_initialized();
+  if (interpreting) {
+    interp->preGCAction_here(false);
+    interp->flushInterpreterCaches(); // oops in the caches may be freed below
+    interp->roots.flush_freeContexts();
+  }
+
+  Oop* first_promoted = (Oop*)old_space->end_objects();
+  Promote_Closure pc(this);
+  if (interpreting)
+    interp->do_all_roots(&pc);
+  for (int i = 0;  i < remembered_set_capacity;  ++i)
+    if (remembered_set[i].is_mem())
+      objects_to_scan->push(remembered_set[i].as_object());
+  clear_remembered_set();
+  scan_promoted_objects(first_promoted);
+
+  release_space(true);
+  if (interpreting)
+    interp->postGCAction_here(false); // remembers the active contexts again
+
+  ++scavengeCount;
+  scavengeMilliseconds += interp->ioWhicheverMSecs() - start;
+}
+
+
+void Nursery::promote_or_scan_later(Oop x) {
+  if (!x.is_mem())
+    return;
+  Object_p obj = x.as_object();
+  if (is_private(obj))
+    promote(obj);
+  else if (is_remembered(x)) {
+    forget(x);
+    objects_to_scan->push(obj);
+  }
+}
+
+
+// Copy into the old space; the object table makes this the only thing to update.
+Object_p Nursery::promote(Object_p obj) {
+  int ehb = obj->extra_header_bytes();
+  int bnc = obj->bytes_to_next_chunk();
+  Oop x = obj->as_oop();
+  Chunk* src_chunk = obj->my_chunk(ehb);
+  Chunk* dst_chunk = old_space->allocateChunk(ehb + bnc);
+  Object_p new_obj = (Object_p)(Object*)((char*)dst_chunk + ehb);
+
+  DEBUG_MULTIMOVE_CHECK(dst_chunk, src_chunk, (ehb + bnc) / bytes_per_oop);
+  memcpy(dst_chunk, src_chunk, ehb + bnc);
+  The_Memory_System()->object_table->set_object_for(x, new_obj  COMMA_TRUE_OR_NOTHING);
+  src_chunk->make_free_object(ehb + bnc, 3);
+
+  bytesPromotedSinceLastQuery += ehb + bnc;
+  if (The_Memory_System()->is_marking_concurrently())
+    Abstract_Mark_Sweep_Collector::regrey_moved_object(new_obj);
+  return new_obj;
+}
+
+
+// Cheney-style: the promoted objects are contiguous at the end of the old space.
+void Nursery::scan_promoted_objects(Oop* first_promoted) {
+  Chunk* c = (Chunk*)first_promoted;
+  for (;;) {
+    if (c < (Chunk*)old_space->end_objects()) {
+      Object* obj = c->object_from_chunk();
+      c = obj->nextChunk();
+      scan_fields(obj, &Nursery::promote_or_scan_later);
+    }
+    else if (!objects_to_scan->is_empty())
+      scan_fields(objects_to_scan->pop(), &Nursery::promote_or_scan_later);
+    else
+      break;
+  }
+}
+
+
+// Turn every run of free (and, after a scavenge, private) chunks into one free chunk,
+// and start allocating from the lowest one.
+void Nursery::release_space(bool private_objects_are_dead) {
+  bool any_escaped = false;
+  Chunk* run = NULL;
+  for (Chunk *c = (Chunk*)startOfMemory(), *next = NULL;  c < (Chunk*)end_of_space();  c = next) {
+    Object* obj = c->object_from_chunk();
+    next = obj->nextChunk();
+    if (!obj->isFreeObject()) {
+      bool escaped = is_escaped(obj);
+      if (escaped  ||  !private_objects_are_dead) {
+        any_escaped |= escaped;
+        if (run != NULL)  make_gap(run, c);
+        run = NULL;
+        continue;
+      }
+      The_Memory_System()->object_table->free_oop(obj->as_oop()  COMMA_TRUE_OR_NOTHING);
+    }
+    if (run == NULL)  run = c;
+  }
+  if (run != NULL)  make_gap(run, (Chunk*)end_of_space());
+  have_escaped_objects = any_escaped;
+
+  gap_start = gap_top = startOfMemory();
+  find_next_gap();
+}
+
+
+void Nursery::make_gap(Chunk* from, Chunk* to) {
+  if (have_escaped_objects)
+    clear_escaped(from, to);
+  from->make_free_object((char*)to - (char*)from, 3);
+}
+
+
+bool Nursery::find_next_gap() {
+  for (Chunk *c = (Chunk*)gap_top, *next = NULL;  c < (Chunk*)end_of_space();  c = next) {
+    Object* obj = c->object_from_chunk();
+    next = obj->nextChunk();
+    if (obj->isFreeObject()) {
+      gap_start = (Oop*)c;
+      gap_top   = (Oop*)next;
+      return true;
+    }
+  }
+  gap_start = gap_top = end_of_space();
+  return false;
+}
+
+
+// Called with all cores safepointed, e.g. before enumerating every object.
+// Returns false if the old space ran out of room.
+bool Nursery::tenure_everything() {
+  Safepoint_Ability sa(false);
+  bool all_moved = true;
+  for (Chunk *c = (Chunk*)startOfMemory(), *next = NULL;  c < (Chunk*)end_of_space();  c = next) {
+    Object_p obj = (Object_p)c->object_from_chunk();
+    next = obj->nextChunk();
+    if (obj->isFreeObject())
+      continue;
+    if (has_room_in_old_space_for((char*)next - (char*)c))
+      promote(obj);
+    else
+      all_moved = false;
+  }
+  release_space(false);
+  if (all_moved)
+    clear_remembered_set();
+  return all_moved;
+}
+
+
+// Called by the owning core when a full GC sweeps, once the old space has been compacted:
+// free what is not marked, and move the rest into the old space while there is room.
+void Nursery::sweep_and_tenure_after_full_GC() {
+  Safepoint_Ability sa(false);
+  for (Chunk *c = (Chunk*)startOfMemory(), *next = NULL;  c < (Chunk*)end_of_space();  c = next) {
+    Object_p obj = (Object_p)c->object_from_chunk();
+    next = obj->nextChunk();
+    if (obj->isFreeObject())
+      continue;
+    if (!obj->is_marked()) {
+      if (!Memory_System::use_mark_bitmap) // else it is gone already, see Memory_System::free_unmarked_objects_in_object_table
+        The_Memory_System()->object_table->free_oop(obj->as_oop()  COMMA_TRUE_OR_NOTHING);
+      c->make_free_object((char*)next - (char*)c, 0);
+      continue;
+    }
+    obj->unmark_without_store_barrier();
+    if (has_room_in_old_space_for((char*)next - (char*)c))
+      promote(obj);
+  }
+  if (Memory_System::use_mark_bitmap) // there may be marks left where objects were moved away from while marking
+    The_Memory_System()->mark_bitmap()->clear_range(The_Memory_System()->mark_bit_index(startOfMemory()),
+                                                    The_Memory_System()->mark_bit_index(end_of_space()));
+  release_space(false);
+}
+
+
+bool Nursery::is_empty() {
+  FOR_EACH_OBJECT_IN_HEAP(this, obj)
+    if (!obj->isFreeObject())
+      return false;
+  return true;
+}
+
+
+bool Nursery::verify() {
+  bool ok = Abstract_Object_Heap::verify();
+  for (int i = 0;  i < remembered_set_capacity;  ++i)
+    if (remembered_set[i].is_mem()  &&  is_private(remembered_set[i].as_object())) {
+      lprintf("nursery: remembered object is young\n");
+      ok = false;
+    }
+  return ok;
+}
+
+
+void Nursery::print(FILE*) {
+  lprintf("nursery: start %p, end %p, gap %p-%p, %d scavenges taking %d ms, %d bytes promoted, %d remembered\n",
+          startOfMemory(), end_of_space(), gap_start, gap_top,
+          scavengeCount, scavengeMilliseconds, bytesPromotedSinceLastQuery, remembered_set_used);
+}
+
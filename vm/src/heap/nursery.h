@@ -0,0 +1,154 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+// A per-core young generation, carved out of the top of the core's read_write heap
+// (see Memory_System::is_address_young).
+//
+// Only the owning core allocates here, and the invariant is that other cores cannot reach
+// the young objects that have not escaped: those are reachable only from the owner's roots,
+// from each other, from escaped objects of this nursery, and from the old contexts
+// the owner stores into without barriers (so beRootIfOld remembers them).
+// When a young object could become visible to another core, because it is stored into an object
+// outside this nursery, or because control or a process is handed to another core,
+// it escapes together with everything young it can reach.
+// Escaping does not move anything, since callers hold Object_p's across stores;
+// it only sets a bit in escaped_bits, and from then on the object is treated as old.
+//
+// A scavenge copies the survivors that have not escaped into the old space, and frees the rest,
+// updating only object table entries; escaped objects stay where they are until the next full GC.
+// So a scavenge only has to look at the owning core's roots and remembered set,
+// and needs no global safepoint.
+//
+// Allocation goes downwards from the top of the current gap, which is a free chunk,
+// so that the nursery can be walked at all times.
+
+class Nursery: public Abstract_Object_Heap {
+  Multicore_Object_Heap* old_space; // survivors go here
+
+  u_int32* escaped_bits; // one per word, set for every word of an escaped object
+  bool have_escaped_objects;
+  Oop* gap_start;        // the free chunk being allocated from
+  Oop* gap_top;
+
+  // open-addressed set of objects outside the nursery, or escaped, that may refer to private young objects,
+  // mostly contexts this core stores into without barriers
+  static const int initial_remembered_set_capacity = 1024; // power of two
+  Oop* remembered_set;
+  int remembered_set_capacity;
+  int remembered_set_used; // including forgotten slots
+
+  GC_Oop_Stack* objects_to_scan;
+
+  u_int32 scavengeCount, scavengeMilliseconds;
+  u_int32 bytesPromotedSinceLastQuery;
+
+ public:
+  void* operator new(size_t size) { return Memory_Semantics::shared_calloc(1, size); }
+
+  void initialize_nursery(Multicore_Object_Heap* old, void* mem, int size);
+
+  // returns NULL if the object had better go into the old space
+  inline Chunk* allocateChunk_for_a_new_object(oop_int_t total_bytes);
+
+  bool is_escaped(void* p) {
+    int i = (Oop*)p - startOfMemory();
+    return escaped_bits[i >> 5] & (1 << (i & 31));
+  }
+  // young and has not escaped
+  bool is_private(void* p) { return contains(p)  &&  !is_escaped(p); }
+
+  void publish(Oop);
+  void remember(Object_p);
+  bool is_remembered(Oop x) { return remembered_set[index_of_remembered(x)] == x; }
+
+  void scavenge(const char* why);
+  bool tenure_everything();
+  void forget_unmarked_remembered_objects();
+  void forward_remembered_set();
+  void sweep_and_tenure_after_full_GC();
+
+  bool is_empty();
+  bool verify();
+  void print(FILE*);
+
+ private:
+  static Oop never_used() { return Oop::from_int(0); }
+  static Oop forgotten()  { return Oop::from_int(1); }
+  int index_of_remembered(Oop);
+  void add_to_remembered_set(Oop);
+  void grow_remembered_set();
+  void rehash_remembered_set(int new_capacity);
+  void forget(Oop);
+  void clear_remembered_set();
+  void remember_interpreter_contexts();
+
+  void set_escaped(Object*);
+  void clear_escaped(Chunk*, Chunk*);
+  void escape_or_scan_later(Oop);
+
+  friend class Promote_Closure;
+  void promote_or_scan_later(Oop);
+  Object_p promote(Object_p);
+  void scan_promoted_objects(Oop* first_promoted);
+  void scan_fields(Object*, void (Nursery::*)(Oop));
+  bool has_room_in_old_space_for(oop_int_t bytes) {
+    return old_space->bytesLeft()  >  u_int32(bytes + old_space->get_lowSpaceThreshold());
+  }
+  void release_space(bool private_objects_are_dead);
+  void make_gap(Chunk*, Chunk*);
+  bool find_next_gap();
+
+  bool fits_in_gap(oop_int_t total_bytes) {
+    oop_int_t left = (char*)gap_top - (char*)gap_start;
+    // what is left over must still be a free chunk
+    return left == total_bytes  ||  left >= total_bytes + preheader_byte_size + (oop_int_t)sizeof(Oop);
+  }
+  // Big objects would just get copied again soon, so they go straight to the old space.
+  oop_int_t max_object_bytes() { return ((char*)end_of_space() - (char*)startOfMemory()) / 8; }
+};
+
+
+inline Chunk* Nursery::allocateChunk_for_a_new_object(oop_int_t total_bytes) {
+  if (total_bytes > max_object_bytes())
+    return NULL;
+  for (bool have_scavenged = false;  !fits_in_gap(total_bytes);  ) {
+    // While marking concurrently, the markers may hold addresses of objects freed since,
+    // so neither reuse free chunks nor scavenge till it is done.
+    if (The_Memory_System()->is_marking_concurrently())
+      return NULL;
+    if (find_next_gap())
+      continue;
+    // Scavenging moves objects, so only do it where a GC would have been OK.
+    if (have_scavenged  ||  !The_Squeak_Interpreter()->safepoint_ability->is_able())
+      return NULL;
+    scavenge("nursery full");
+    have_scavenged = true;
+  }
+  gap_top = (Oop*)((char*)gap_top - total_bytes);
+  if (gap_top > gap_start) // just shrink the free chunk, its filler is still there
+    *(oop_int_t*)((char*)gap_start + preheader_byte_size) =
+      Object::make_free_object_header((char*)gap_top - (char*)gap_start - preheader_byte_size);
+  if (check_assertions)
+    oopset_no_store_check(gap_top, Oop::from_bits(Oop::Illegals::allocated), total_bytes/sizeof(Oop));
+  return (Chunk*)gap_top;
+}
+
+
+class Publish_Closure: public Oop_Closure {
+ public:
+  Publish_Closure() : Oop_Closure() {}
+  void value(Oop* p, Object_p) { The_Memory_System()->my_nursery()->publish(*p); }
+  virtual const char* class_name(char*) { return "Publish_Closure"; }
+};
+
@@ -0,0 +1,39 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+// A walk over all heaps in which every core does its own heaps, while the core that started it waits for the others.
+// The other cores handle the parallelHeapScanMessage wherever they are, typically spinning in a safepoint.
+// Lives on the stack of the core that started it, so without threads, or with only one core,
+// run does all the heaps itself, see Memory_System::is_scanning_heaps_in_parallel.
+// A subclass must not mind being called on several cores at once.
+
+class Parallel_Heap_Scan {
+  int finished_helpers; // accessed atomically
+
+protected:
+  virtual void scan_heaps_of(int rank) = 0;
+
+public:
+  Parallel_Heap_Scan() { finished_helpers = 0; }
+
+  void run();
+
+  void help() {
+    scan_heaps_of(Logical_Core::my_rank());
+    OS_Interface::mem_fence();
+    OS_Interface::atomic_fetch_and_add(&finished_helpers, 1);
+  }
+  bool are_all_helpers_finished() { return finished_helpers == Logical_Core::group_size - 1; }
+};
+
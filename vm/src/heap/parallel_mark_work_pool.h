@@ -0,0 +1,142 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+// Shared state for a parallel mark.
+// Every core drains a private GC_Oop_Stack; when that stack gets deep, the core
+// publishes a batch of grey objects into its slot here, where idle cores can steal them.
+// Weak roots found by any core are collected here, too, so the core running the GC
+// can finalize them once marking has terminated everywhere.
+// Lives in shared memory and is reused from one GC to the next.
+
+class Parallel_Mark_Work_Pool {
+public:
+  static const int slot_capacity = 4096;
+  static const int transfer_batch = 256;
+  static const int weak_root_capacity = 65536;
+
+private:
+  struct Slot {
+    OS_Interface::Mutex lock;
+    int count;
+    Object* objs[slot_capacity];
+  } slots[Max_Number_Of_Cores];
+
+  int active_markers;   // accessed atomically, zero means marking has terminated
+  int finished_markers; // accessed atomically, number of helper cores that are done
+  int weak_root_count;  // accessed atomically
+  Oop weak_roots[weak_root_capacity];
+
+public:
+  void* operator new(size_t s) { return Memory_Semantics::shared_malloc(s); }
+
+  Parallel_Mark_Work_Pool() {
+    for (int i = 0;  i < Max_Number_Of_Cores;  ++i) {
+      OS_Interface::mutex_init(&slots[i].lock);
+      slots[i].count = 0;
+    }
+    reset(0, false);
+  }
+
+  // When finishing a concurrent mark, keep the weak roots found so far.
+  void reset(int number_of_markers, bool keep_weak_roots) {
+    active_markers = number_of_markers;
+    finished_markers = 0;
+    if (!keep_weak_roots)  weak_root_count = 0;
+    OS_Interface::mem_fence();
+  }
+
+  // Owner side: move up to n objects from the top of my private stack into my slot.
+  void publish(GC_Oop_Stack* s, int n) {
+    Slot* sl = &slots[Logical_Core::my_rank()];
+    OS_Interface::mutex_lock(&sl->lock);
+    for (int i = 0;  i < n  &&  sl->count < slot_capacity  &&  !s->is_empty();  ++i)
+      sl->objs[sl->count++] = s->pop();
+    OS_Interface::mutex_unlock(&sl->lock);
+  }
+
+  // Only bother when my private stack is deep and there is room in my slot.
+  void publish_surplus(GC_Oop_Stack* s) {
+    if (s->size() < 2 * transfer_batch)  return;
+    if (slots[Logical_Core::my_rank()].count > slot_capacity - transfer_batch)  return;
+    publish(s, transfer_batch);
+  }
+
+  // Take up to transfer_batch objects from victim's slot, returns true if got any.
+  bool take_from(int victim, GC_Oop_Stack* s) {
+    Slot* sl = &slots[victim];
+    if (sl->count == 0)  return false;
+    OS_Interface::mutex_lock(&sl->lock);
+    int n = 0;
+    for ( ;  n < transfer_batch  &&  sl->count > 0;  ++n)
+      s->push(sl->objs[--sl->count]);
+    OS_Interface::mutex_unlock(&sl->lock);
+    return n > 0;
+  }
+
+  // Reclaim my own slot first, then try the others starting with my neighbor.
+  bool steal(GC_Oop_Stack* s) {
+    int me = Logical_Core::my_rank();
+    if (take_from(me, s))  return true;
+    for (int i = 1;  i < Logical_Core::group_size;  ++i)
+      if (take_from((me + i) % Logical_Core::group_size, s))
+        return true;
+    return false;
+  }
+
+  bool any_published_work() {
+    FOR_ALL_RANKS(i)
+      if (slots[i].count > 0)  return true;
+    return false;
+  }
+
+  // Termination: a core that has run out of work leaves the active set, then either rejoins
+  // if anything got published, or returns once no core is active any more.
+  // Since a core always reclaims its own slot before leaving, no work can be stranded.
+  bool steal_or_terminate(GC_Oop_Stack* s) {
+    if (steal(s))  return true;
+    OS_Interface::atomic_fetch_and_add(&active_markers, -1);
+    for (;;) {
+      if (any_published_work()) {
+        OS_Interface::atomic_fetch_and_add(&active_markers, 1);
+        if (steal(s))  return true;
+        OS_Interface::atomic_fetch_and_add(&active_markers, -1);
+      }
+      OS_Interface::mem_fence();
+      if (active_markers == 0)  return false;
+    }
+  }
+
+  // Concurrent marking has no termination protocol of its own, since the final remark drains whatever is left.
+  // It suffices to notice when no core seems to have anything to do.
+  void concurrent_marker_became_busy() { OS_Interface::atomic_fetch_and_add(&active_markers, 1); }
+  bool concurrent_marker_became_idle_and_no_work_is_left() {
+    return OS_Interface::atomic_fetch_and_add(&active_markers, -1) == 1  &&  !any_published_work();
+  }
+
+  void helper_is_finished() {
+    OS_Interface::mem_fence();
+    OS_Interface::atomic_fetch_and_add(&finished_markers, 1);
+  }
+  bool are_all_helpers_finished() { return finished_markers == Logical_Core::group_size - 1; }
+
+  bool add_weak_root(Oop x) {
+    int i = OS_Interface::atomic_fetch_and_add(&weak_root_count, 1);
+    if (i >= weak_root_capacity)  return false;
+    weak_roots[i] = x;
+    return true;
+  }
+  int get_weak_root_count() { return min(weak_root_count, weak_root_capacity); }
+  Oop weak_root_at(int i) { return weak_roots[i]; }
+};
+
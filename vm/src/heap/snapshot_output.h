@@ -0,0 +1,48 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+// Where Multicore_Object_Heap::write_image_file puts the words of a heap.
+// Either appends them to the image file, or, when each core writes its own heaps,
+// pwrites them from the position of the heap in the file, see Memory_System::writeImageFileIO.
+// Never touches the interpreter, so the caller checks has_failed and fails the primitive.
+
+class Snapshot_Output {
+  static const int buffer_words = 16 * 1024;
+
+  FILE* file;   // NULL when pwriting
+  int   fd;
+  off_t position;
+  u_int64 bytes_written;
+  bool  failed;
+  int   word_count;
+  int32 buffer[buffer_words];
+
+  void init() { bytes_written = 0;  failed = false;  word_count = 0; }
+
+public:
+  Snapshot_Output(FILE* f)           { file = f;     fd = -1;  position = 0;    init(); }
+  Snapshot_Output(int d, off_t pos)  { file = NULL;  fd = d;   position = pos;  init(); }
+  ~Snapshot_Output() { flush(); }
+
+  void put_long(int32 x) {
+    if (word_count == buffer_words)
+      flush();
+    buffer[word_count++] = x;
+  }
+  void flush();
+
+  bool has_failed() { return failed; }
+  u_int64 bytes() { return bytes_written + word_count * sizeof(int32); }
+};
+
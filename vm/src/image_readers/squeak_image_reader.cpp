@@ -16,6 +16,8 @@
 
 # include <fcntl.h>
 # include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
 
 
 void Squeak_Image_Reader::read(char* fileName, Memory_System* ms, Squeak_Interpreter* i) {
@@ -30,7 +32,7 @@ void Squeak_Image_Reader::fake_read(char* fileName, Memory_System* ms, Squeak_In
 
   //mimic reader
   Memory_Semantics::shared_malloc(sir->dataSize);
-  malloc(sir->dataSize);
+  __attribute__((unused)) void* mimic_memory = malloc(sir->dataSize);
 
   i->restore_all_from_checkpoint(sir->dataSize, sir->lastHash, sir->savedWindowSize, sir->fullScreenFlag);
   imageNamePut_on_all_cores(sir->file_name, strlen(sir->file_name));
@@ -44,6 +46,8 @@ Squeak_Image_Reader::Squeak_Image_Reader(char* fn, Memory_System* ms, Squeak_Int
   file_name = fn;
   image_file = fopen(file_name, "r");
   swap_bytes = false;
+  mapped_file = NULL;
+  mapped_bytes = 0;
   if (image_file == NULL) {
     char buf[BUFSIZ];
     snprintf(buf, sizeof(buf), "Could not open image file %s", file_name);
@@ -77,36 +81,45 @@ readImageFromFile: f HeapSize: desiredHeapSize StartingAt: imageOffset
 
   read_header();
 
-  if (Verbose_Debug_Prints) fprintf(stdout, "allocating memory for snapshot\n");
-
-  // "allocate a contiguous block of memory for the Squeak heap"
-  memory = (char*)Memory_Semantics::shared_malloc(dataSize);
-  assert_always(memory != NULL);
-
-  /*
-	memStart := self startOfMemory.
-	memoryLimit := (memStart + heapSize) - 24.  "decrease memoryLimit a tad for safety"
-	endOfMemory := memStart + dataSize.
-  */
+  memory = map_image_file();
+  if (memory == NULL) {
+    if (Verbose_Debug_Prints) fprintf(stdout, "allocating memory for snapshot\n");
+
+    // "allocate a contiguous block of memory for the Squeak heap"
+    memory = (char*)Memory_Semantics::shared_malloc(dataSize);
+    assert_always(memory != NULL);
+
+    /*
+    memStart := self startOfMemory.
+    memoryLimit := (memStart + heapSize) - 24.  "decrease memoryLimit a tad for safety"
+    endOfMemory := memStart + dataSize.
+    */
+
+    // "position file after the header"
+    if (Verbose_Debug_Prints) fprintf(stdout, "reading objects in snapshot\n");
+    if (fseek(image_file, headerStart + headerSize, SEEK_SET)) {
+      perror("seek");
+      fatal();
+    }
 
-  // "position file after the header"
-  if (Verbose_Debug_Prints) fprintf(stdout, "reading objects in snapshot\n");
-  if (fseek(image_file, headerStart + headerSize, SEEK_SET)) {
-    perror("seek");
-    fatal();
+    // "read in the image in bulk, then swap the bytes if necessary"
+    xfread(memory, 1, dataSize, image_file);
   }
 
-  // "read in the image in bulk, then swap the bytes if necessary"
-  xfread(memory, 1, dataSize, image_file);
-
   // "First, byte-swap every word in the image. This fixes objects headers."
-  if (swap_bytes) reverseBytes((int32*)&memory[0], (int32*)&memory[dataSize]);
+  if (swap_bytes) {
+    fprintf(stdout, "reversing bytes\n");
+    reverseBytes((int32*)&memory[0], (int32*)&memory[dataSize]);
+    fprintf(stdout, "done reversing bytes\n");
+  }
 
   // "Second, return the bytes of bytes-type objects to their orginal order."
-  if (swap_bytes) byteSwapByteObjects();
+  // When the cores copy their shares in parallel, each does it for the objects it copies, see Snapshot_Distribution.
+  if (swap_bytes  &&  !Memory_System::is_scanning_heaps_in_parallel()) byteSwapByteObjects();
   
   Safepoint_Ability sa(false); // for distributing objects and putting image name
   distribute_objects();
+  unmap_image_file();
   imageNamePut_on_all_cores(file_name, strlen(file_name));
   
   // we need to reoder floats if the image was a Cog image
@@ -116,6 +129,37 @@ readImageFromFile: f HeapSize: desiredHeapSize StartingAt: imageOffset
 }
 
 
+// With threads, every core can read a private mapping of the file, so distribute_objects copies
+// the objects straight from the page cache into the heaps, and the image is never held twice.
+// The mapping is copy-on-write because converting the oops and swapping the bytes write into it;
+// byte objects, usually the bulk of an image, are only read and stay shared with the page cache.
+// With processes the other cores could not see the mapping, so read the image into shared memory.
+char* Squeak_Image_Reader::map_image_file() {
+  if (!Using_Threads)
+    return NULL;
+  size_t bytes = headerStart + headerSize + dataSize;
+  struct stat st;
+  if (fstat(fileno(image_file), &st)  ||  size_t(st.st_size) < bytes)
+    return NULL;
+  mapped_file = OS_Interface::map_file_copy_on_write(fileno(image_file), bytes);
+  if (mapped_file == NULL)
+    return NULL;
+  mapped_bytes = bytes;
+  if (Verbose_Debug_Prints) fprintf(stdout, "mapped snapshot\n");
+  return &mapped_file[headerStart + headerSize];
+}
+
+
+void Squeak_Image_Reader::unmap_image_file() {
+  if (mapped_file == NULL)
+    return;
+  if (munmap(mapped_file, mapped_bytes))
+    perror("munmap of image file");
+  mapped_file = memory = NULL;
+  mapped_bytes = 0;
+}
+
+
 /** Inspired by:
  !Interpreter methodsFor: 'image save/restore' stamp: 'dtl 10/5/2010 23:54'!
  normalizeFloatOrderingInImage
@@ -123,11 +167,44 @@ readImageFromFile: f HeapSize: desiredHeapSize StartingAt: imageOffset
  "Float objects were saved in platform word ordering. Reorder them into the
  traditional object format."
 */
+// The other cores have not received the interpreter yet, so they get the compact classes from here instead of from fetchClass,
+// and must not remember anything to evacuate, as swapFloatParts_for_cog_compatibility would. Only runs with threads.
+class Float_Normalization: public Parallel_Heap_Scan {
+  Oop float_class;
+  Object* compact_classes;
+
+  void scan_heaps_of(int rank) {
+    for (int mutability = 0;  mutability < Memory_System::max_num_mutabilities;  ++mutability) {
+      Multicore_Object_Heap* h = The_Memory_System()->heaps[rank][mutability];
+      FOR_EACH_OBJECT_IN_HEAP(h, obj) {
+        if (obj->isFreeObject())
+          continue;
+        oop_int_t cc = obj->compact_class_index();
+        if ((cc == 0  ?  obj->get_class_oop()  :  compact_classes->fetchPointer(cc - 1))  !=  float_class)
+          continue;
+        // a change of format rather than a store, so a read-mostly Float stays where it is
+        int32* data = &obj->as_int32_p()[Object::BaseHeaderSize/sizeof(int32)];
+        int32 word_0 = data[0];  data[0] = data[1];  data[1] = word_0;
+      }
+    }
+  }
+public:
+  Float_Normalization(Oop c) : Parallel_Heap_Scan() {
+    float_class = c;
+    compact_classes = The_Squeak_Interpreter()->splObj(Special_Indices::CompactClasses).as_object();
+  }
+};
+
+
 void Squeak_Image_Reader::normalize_float_ordering_in_image() {
   Squeak_Interpreter* const interp = The_Squeak_Interpreter();
   Memory_System* const mem_sys = The_Memory_System();
   
   Oop cls = interp->splObj(Special_Indices::ClassFloat);
+  if (Memory_System::is_scanning_heaps_in_parallel()) { // each core swaps the Floats in its own heaps
+    Float_Normalization(cls).run();
+    return;
+  }
   for (Oop floatInstance = mem_sys->initialInstanceOf(cls);
        floatInstance != interp->roots.nilObj;
        floatInstance  = mem_sys->nextInstanceAfter(floatInstance) ) {
@@ -159,7 +236,7 @@ void Squeak_Image_Reader::read_header() {
   headerStart = ftell(image_file) - bytesPerWord;
   headerSize         = get_long();
   dataSize           = get_long();
-  oldBaseAddr        = (char*)get_long();
+  oldBaseAddr        = (char*)uintptr_t(u_int32(get_long()));
   specialObjectsOop = Oop::from_bits(get_long());
 
   lastHash = get_long();
@@ -236,16 +313,22 @@ void Squeak_Image_Reader::distribute_objects() {
 
   memory_system->initialize_from_snapshot(dataSize, savedWindowSize, fullScreenFlag, lastHash);
   
-  for (Chunk *c = (Chunk*)base, *nextChunk = NULL;
-       (char*)c <  &base[total_bytes];
-       c = nextChunk) {
-    Object* obj = c->object_from_chunk_without_preheader();
-    if (check_many_assertions &&  (char*)obj - memory == (char*)specialObjectsOop.bits() - oldBaseAddr)
-      lprintf("about to do specialObjectsOop");
-    nextChunk = obj->nextChunk();
-    if (!obj->isFreeObject()) {
-      obj->do_all_oops_of_object_for_reading_snapshot(this);
-      memory_system->ask_cpu_core_to_add_object_from_snapshot_allocating_chunk(oop_for_addr(obj), obj);
+  if (Memory_System::is_scanning_heaps_in_parallel())
+    distribute_objects_in_parallel();
+  else if (Omit_Object_Table)
+    place_objects_then_convert_their_oops();
+  else {
+    for (Chunk *c = (Chunk*)base, *nextChunk = NULL;
+         (char*)c <  &base[total_bytes];
+         c = nextChunk) {
+      Object* obj = c->object_from_chunk_without_preheader();
+      if (check_many_assertions &&  (char*)obj - memory == (char*)uintptr_t(u_oop_int_t(specialObjectsOop.bits())) - oldBaseAddr)
+        lprintf("about to do specialObjectsOop");
+      nextChunk = obj->nextChunk();
+      if (!obj->isFreeObject()) {
+        obj->do_all_oops_of_object_for_reading_snapshot(this);
+        memory_system->ask_cpu_core_to_add_object_from_snapshot_allocating_chunk(oop_for_addr(obj), obj);
+      }
     }
   }
   // Remap specialObjectsOop
@@ -261,12 +344,122 @@ void Squeak_Image_Reader::distribute_objects() {
 
 
 
+// Without the object table, the oop of an object is where it lands,
+// so all objects must have been placed before any of their contents can be converted.
+void Squeak_Image_Reader::place_objects_then_convert_their_oops() {
+  for (Chunk *c = (Chunk*)memory, *nextChunk = NULL;  (char*)c < &memory[dataSize];  c = nextChunk) {
+    Object* obj = c->object_from_chunk_without_preheader();
+    nextChunk = obj->nextChunk();
+    if (!obj->isFreeObject())
+      object_oops[((char*)obj - memory) / sizeof(Oop)] = memory_system->ask_cpu_core_to_add_object_from_snapshot_allocating_chunk(obj)->as_oop();
+  }
+  for (Chunk *c = (Chunk*)memory, *nextChunk = NULL;  (char*)c < &memory[dataSize];  c = nextChunk) {
+    Object* obj = c->object_from_chunk_without_preheader();
+    nextChunk = obj->nextChunk();
+    if (!obj->isFreeObject())
+      oop_for_addr(obj).as_object()->do_all_oops_of_object_for_reading_snapshot(this);
+  }
+}
+
+
+// Each core copies its share of the snapshot into its own heaps, instead of being sent the objects one by one,
+// and puts the bytes of byte objects back in order as it goes.
+// Without the object table, it then converts the oops of the objects it placed, once all are placed.
+class Snapshot_Distribution: public Parallel_Heap_Scan {
+  Squeak_Image_Reader* reader;
+  Object** shares[Max_Number_Of_Cores];
+  int share_sizes[Max_Number_Of_Cores];
+  bool converting;
+
+  void scan_heaps_of(int rank) {
+    Memory_System* ms = The_Memory_System();
+    for (int i = 0;  i < share_sizes[rank];  ++i) {
+      Object* obj = shares[rank][i];
+      if (converting)
+        reader->oop_for_addr(obj).as_object()->do_all_oops_of_object_for_reading_snapshot(reader);
+      else {
+        Object* dst_obj;
+        if (Omit_Object_Table) {
+          dst_obj = ms->add_object_from_snapshot_to_a_local_heap_allocating_chunk(Oop(), obj);
+          reader->object_oops[((char*)obj - reader->memory) / sizeof(Oop)] = dst_obj->as_oop();
+        }
+        else {
+          Oop oop = reader->oop_for_addr(obj);
+          dst_obj = ms->add_object_from_snapshot_to_a_local_heap_allocating_chunk(oop, obj);
+          ms->object_table->set_object_for(oop, (Object_p)dst_obj  COMMA_FALSE_OR_NOTHING);
+        }
+        if (reader->swap_bytes) // while the object is still in the cache
+          dst_obj->byteSwapIfByteObject();
+      }
+    }
+  }
+
+public:
+  Snapshot_Distribution(Squeak_Image_Reader* r, int* counts) {
+    reader = r;
+    converting = false;
+    FOR_ALL_RANKS(rank) {
+      shares[rank] = (Object**)malloc(counts[rank] * sizeof(Object*));
+      share_sizes[rank] = 0;
+    }
+  }
+  ~Snapshot_Distribution() {
+    FOR_ALL_RANKS(rank)
+      free(shares[rank]);
+  }
+  void add(int rank, Object* obj) { shares[rank][share_sizes[rank]++] = obj; }
+  void convert() { converting = true;  run(); }
+};
+
+
+// The main core still picks the rank of every object, and with the object table converts the oops,
+// but the copying needs no message per object.
+// The ranks are kept by object ordinal between the walks, since without the object table picking one is not repeatable.
+void Squeak_Image_Reader::distribute_objects_in_parallel() {
+  u_char* ranks = (u_char*)malloc(dataSize / sizeof(Oop));
+  int counts[Max_Number_Of_Cores];
+  FOR_ALL_RANKS(rank)
+    counts[rank] = 0;
+
+  int n = 0;
+  for (Chunk *c = (Chunk*)memory, *nextChunk = NULL;  (char*)c < &memory[dataSize];  c = nextChunk) {
+    Object* obj = c->object_from_chunk_without_preheader();
+    nextChunk = obj->nextChunk();
+    if (obj->isFreeObject())
+      continue;
+    int rank;
+    if (Omit_Object_Table)
+      rank = memory_system->assign_rank_for_snapshot_object();
+    else {
+      obj->do_all_oops_of_object_for_reading_snapshot(this);
+      rank = memory_system->object_table->rank_for_adding_object_from_snapshot(oop_for_addr(obj));
+    }
+    ranks[n++] = rank;
+    ++counts[rank];
+  }
+
+  Snapshot_Distribution d(this, counts);
+  n = 0;
+  for (Chunk *c = (Chunk*)memory, *nextChunk = NULL;  (char*)c < &memory[dataSize];  c = nextChunk) {
+    Object* obj = c->object_from_chunk_without_preheader();
+    nextChunk = obj->nextChunk();
+    if (!obj->isFreeObject())
+      d.add(ranks[n++], obj);
+  }
+  free(ranks);
+
+  d.run();
+  if (Omit_Object_Table)
+    d.convert();
+}
+
+
 Oop Squeak_Image_Reader::oop_for_oop(Oop x) {
-  return oop_for_relative_addr(x.bits() - (int)oldBaseAddr);
+  return oop_for_relative_addr(x.bits() - int32(intptr_t(oldBaseAddr)));
 }
 
 Oop Squeak_Image_Reader::oop_for_addr(Object* obj) {
-  return oop_for_relative_addr(int(obj) - int(memory));
+  return oop_for_relative_addr(int((char*)obj - memory));
 }
 
 
@@ -275,6 +468,7 @@ Oop Squeak_Image_Reader::oop_for_relative_addr(int relative_addr) {
   Oop* addr_in_table = &object_oops[relative_addr / sizeof(Oop)];
   Object* obj = (Object*) &memory[relative_addr];
   if (addr_in_table->bits() == 0) {
+    if (Omit_Object_Table) fatal("object was not placed");
     Multicore_Object_Table* ot = memory_system->object_table;
     *addr_in_table = ot->allocate_OTE_for_object_in_snapshot(obj);
   }
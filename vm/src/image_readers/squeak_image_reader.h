@@ -14,6 +14,7 @@
 
 class Squeak_Image_Reader {
   friend class Convert_Closure;
+  friend class Snapshot_Distribution;
  private:
   char* file_name;
   FILE* image_file;
@@ -23,6 +24,8 @@ class Squeak_Image_Reader {
   u_int32 headerStart, headerSize, dataSize, extraVMMemory;
 
   char *oldBaseAddr, *memory;
+  char* mapped_file; // NULL unless memory points into a mapping of the image file, see map_image_file
+  size_t mapped_bytes;
   Oop* object_oops;
 
 
@@ -40,10 +43,14 @@ class Squeak_Image_Reader {
   bool is_cog_image_with_reodered_floats();
   static int32 image_format_version();
   void read_header();
+  char* map_image_file();
+  void unmap_image_file();
 
   void byteSwapByteObjects();
   void normalize_float_ordering_in_image();
   void distribute_objects();
+  void distribute_objects_in_parallel();
+  void place_objects_then_convert_their_oops();
   
 
 
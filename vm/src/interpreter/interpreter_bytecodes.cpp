@@ -218,7 +218,7 @@ void Squeak_Interpreter::secondExtendedSendBytecode() {
   roots.messageSelector = literal(descriptor & 0x3f);
   set_argumentCount( descriptor >> 6 );
   assert (!stackValue(get_argumentCount()).is_mem()
-          || The_Memory_System()->object_table->probably_contains((void*)stackValue(get_argumentCount()).bits()));
+          || The_Memory_System()->object_table->probably_contains_oop(stackValue(get_argumentCount())));
   normalSend();
 }
 
@@ -748,7 +748,7 @@ void Squeak_Interpreter::sendLiteralSelectorBytecode() {
 
   if (check_assertions && !roots.messageSelector.is_mem()) {
     Printer* p = error_printer;
-    p->printf("on %d: msgSel is int; method bits 0x%x, method->obj 0x%x, method obj 0x%x, method obj as_oop 0x%x, msgSel 0x%x\n",
+    p->printf("on %d: msgSel is int; method bits 0x%x, method->obj %p, method obj %p, method obj as_oop 0x%x, msgSel 0x%x\n",
               Logical_Core::my_rank(), method().bits(), (Object*)method().as_object(), (Object*)method_obj(), method_obj()->as_oop().bits(), roots.messageSelector.bits());
     method_obj()->print(p);
     p->nl();
@@ -112,8 +112,8 @@ void Squeak_Interpreter::primitiveBeCursor() {
     success(offsetObj.is_mem()  &&  (oo = offsetObj.as_object())->lengthOf() >= 2);
     success(bitsObj.is_mem()  &&  (bo = bitsObj.as_object()));
   }
-  oop_int_t offsetX, offsetY;
-  char* cursorBitsIndex;
+  oop_int_t offsetX = 0, offsetY = 0;
+  char* cursorBitsIndex = NULL;
   if (successFlag) {
     offsetX = oo->fetchInteger(0);
     offsetY = oo->fetchInteger(1);
@@ -971,7 +971,6 @@ void Squeak_Interpreter::primitiveFractionalPart() {
 
 void Squeak_Interpreter::primitiveFullGC() {
   pop(1);
-  The_Memory_System()->incrementalGC();
   The_Memory_System()->fullGC("primitiveFullGC");
   pushInteger(The_Memory_System()->bytesLeft(/* true */));
 }
@@ -1078,7 +1077,7 @@ void Squeak_Interpreter::primitiveImageName() {
 
 void Squeak_Interpreter::primitiveIncrementalGC() {
   pop(1);
-  The_Memory_System()->finalize_weak_arrays_since_we_dont_do_incrementalGC();
+  The_Memory_System()->incrementalGC();
   pushInteger(The_Memory_System()->bytesLeft(/* false */));
 }
 
@@ -1186,11 +1185,11 @@ void Squeak_Interpreter::primitiveInterruptSemaphore() {
 void Squeak_Interpreter::primitiveInvokeObjectAsMethod() {
   if (check_many_assertions) assert(roots.newMethod.verify_oop());
   Object_p rao = splObj_obj(Special_Indices::ClassArray)->instantiateClass(get_argumentCount());
-  rao->beRootIfOld();
   oopcpy_no_store_check(rao->as_oop_p() + Object::BaseHeaderSize/sizeof(Oop),
                         stackPointer() - (get_argumentCount() - 1),
                         get_argumentCount(),
                         rao);
+  rao->beRootIfOld();
 
   Oop runSelector = roots.messageSelector;
   Oop runReceiver = stackValue(get_argumentCount());
@@ -141,6 +141,7 @@ Obsolete_Named_Primitive_Table::entry Obsolete_Named_Primitive_Table::contents[]
   { "primitiveSetExtraWordSelector",      "RVMPlugin", "primitiveSetExtraWordSelector",      false },
   { "primitiveEmergencySemaphore",        "RVMPlugin", "primitiveEmergencySemaphore",        true  },
   { "primitiveWriteSnapshot",             "RVMPlugin", "primitiveWriteSnapshot",             true  },
+  { "primitiveBackgroundSnapshot",        "RVMPlugin", "primitiveBackgroundSnapshot",        true  },
   { "primitiveMicrosecondClock",          "RVMPlugin", "primitiveMicrosecondClock",          false },
   { "primitiveCycleCounter",              "RVMPlugin", "primitiveCycleCounter",              false },
   
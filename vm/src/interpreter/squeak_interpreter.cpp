@@ -923,7 +923,7 @@ bool Squeak_Interpreter::balancedStackAfterPrimitive(int delta, int primIdx, int
   if (successFlag) {
     // must have nArgs popped off
     if  ( stackPointer() - activeContext_obj()->as_oop_p() + nArgs ==  delta ) return true;
-    lprintf("balancedStackAfterPrimitive failed: stackPointer 0x%x, activeContext_obj() 0x%x, nArgs %d, delta %d\n",
+    lprintf("balancedStackAfterPrimitive failed: stackPointer %p, activeContext_obj() %p, nArgs %d, delta %d\n",
             _stackPointer, (Object*)activeContext_obj(), nArgs, delta);
     return false;
   }
@@ -932,7 +932,7 @@ bool Squeak_Interpreter::balancedStackAfterPrimitive(int delta, int primIdx, int
 };
 
 void Squeak_Interpreter::printUnbalancedStack(int primIdx, fn_t fn) {
-  lprintf("printUnbalancedStack primitive: %d 0x%x\n", primIdx, fn);
+  lprintf("printUnbalancedStack primitive: %d %p\n", primIdx, fn);
   print_stack_trace(dittoing_stdout_printer);
   unimplemented();
 }
@@ -1140,6 +1140,10 @@ void Squeak_Interpreter::checkForInterrupts(bool is_safe_to_process_events) {
   interruptCheckCounter = interruptCheckCounterFeedBackReset();
 
   The_Memory_System()->handle_low_space_signals();
+  if (Abstract_Mark_Sweep_Collector::concurrent_mark  ||  The_Memory_System()->is_marking_concurrently())
+    Abstract_Mark_Sweep_Collector::do_concurrent_mark_step(); // all cores help with an incremental mark, too
+  if (Memory_System::lazy_sweep)
+    The_Memory_System()->do_lazy_sweep_step();
 
   if (now < lastTick() ||  use_cpu_ms_changed) {
     // ms clock wrapped so correct the nextPollTick
@@ -1149,6 +1153,8 @@ void Squeak_Interpreter::checkForInterrupts(bool is_safe_to_process_events) {
     bool s = successFlag; successFlag = true;
     The_Interactions.run_primitive(Logical_Core::main_rank, (fn_t)ioProcessEvents_wrapper);
     successFlag = s;
+    if (Memory_System::is_snapshotting_in_background()  &&  Logical_Core::running_on_main())
+      The_Memory_System()->poll_background_snapshot();
     // sets interruptPending if interrupt key pressed
     set_nextPollTick(now + 200);
     /*
@@ -1350,6 +1356,8 @@ void Squeak_Interpreter::put_running_process_to_sleep(const char* why) {
   assert_eq(activeContext_obj(), (void*)activeContext().as_object(), "active context is messed up");
   if (Check_Prefetch)  assert_always(have_executed_currentBytecode);
   storeContextRegisters(activeContext_obj()); // xxxxxx redundant maybe with newActiveContext call in start_running
+  if (Memory_System::is_using_nurseries())
+    The_Memory_System()->my_nursery()->publish(activeContext()); // any core may resume it
   aProcess.as_object()->set_suspended_context_of_process(activeContext());
   unset_running_process();
   if (Print_Scheduler_Verbose) {
@@ -1389,7 +1397,7 @@ void Squeak_Interpreter::set_running_process(Oop proc, const char* why) {
   if (Print_Scheduler_Verbose) {
     debug_printer->printf( "scheduler: on %d: set_running_process: ", my_rank());
     proc.print_process_or_nil(debug_printer);
-    debug_printer->printf(", %s prim: 0x%x\n", why, Message_Statics::remote_prim_fn);
+    debug_printer->printf(", %s prim: %p\n", why, Message_Statics::remote_prim_fn);
   }
 
   roots.running_process_or_nil = proc;
@@ -1549,7 +1557,7 @@ void Squeak_Interpreter::print_stack_trace(Printer* p, Object_p proc) {
   if (cntxt != roots.nilObj) ;
   else if ((cntxt = activeContext()) != roots.nilObj) ;
   else {
-    p->printf("on %d: cannot print stack, process 0x%x is running elsewhere\n", my_rank(), (Object*)proc);
+    p->printf("on %d: cannot print stack, process %p is running elsewhere\n", my_rank(), (Object*)proc);
     return;
   }
   for (Oop c = cntxt;
@@ -1787,6 +1795,9 @@ void Squeak_Interpreter::changeClass(Oop rcvr, Oop argClass, bool /* defer */) {
       primitiveFail();  return;
     }
     The_Memory_System()->store_enforcing_coherence(&ro->baseHeader,  (ro->baseHeader & ~Object::CompactClassMask) | ccIndex, ro);
+    // a concurrent marker may have just set the mark bit, so make sure it is set again
+    if (The_Memory_System()->is_marking_concurrently())
+      Abstract_Mark_Sweep_Collector::record_overwritten_oop(rcvr);
   }
   else {
     // exchange class pointer
@@ -1929,7 +1940,8 @@ void Squeak_Interpreter::primitivePerformAt(Oop lookupClass) {
 }
 
 
-void Squeak_Interpreter::snapshot(bool /* embedded */) {
+// With a background_semaphore_index, a forked child writes the image while we resume; see Memory_System::writeImageFile_in_background
+void Squeak_Interpreter::snapshot(bool /* embedded */, int background_semaphore_index) {
 
   Oop r = popStack();
   pushBool(true);
@@ -1961,12 +1973,31 @@ void Squeak_Interpreter::snapshot(bool /* embedded */) {
     }
     lprintf("snapshot: starting GC\n");
     The_Memory_System()->fullGC("snapshot");
-    lprintf("snapshot: cleaning up\n");
-    The_Memory_System()->snapshotCleanUp();
-    lprintf("snapshot: writing image\n");
-    assert_active_process_not_nil();
-    The_Memory_System()->writeImageFile(The_Memory_System()->imageName());
-    assert_active_process_not_nil();
+    if (Memory_System::gc_may_leave_heaps_uncompacted()) // the image must not start with a free chunk, see write_image_file
+      The_Memory_System()->compact_all_heaps("snapshot");
+    // the image file only holds the old spaces; if they are too fragmented for the young objects, compact and try once more
+    bool tenured = The_Memory_System()->tenure_all_nurseries("snapshot");
+    if (!tenured) {
+      lprintf("snapshot: no room to tenure young objects, compacting\n");
+      The_Memory_System()->fullGC("snapshot tenuring");
+      The_Memory_System()->compact_all_heaps("snapshot tenuring");
+      tenured = The_Memory_System()->tenure_all_nurseries("snapshot");
+    }
+    if (!tenured) {
+      lprintf("snapshot: still no room to tenure young objects, not writing image\n");
+      success(false);
+    }
+    else {
+      lprintf("snapshot: cleaning up\n");
+      The_Memory_System()->snapshotCleanUp();
+      lprintf("snapshot: writing image\n");
+      assert_active_process_not_nil();
+      if (background_semaphore_index < 0)
+        The_Memory_System()->writeImageFile(The_Memory_System()->imageName());
+      else if (!The_Memory_System()->writeImageFile_in_background(The_Memory_System()->imageName(), background_semaphore_index))
+        success(false);
+      assert_active_process_not_nil();
+    }
     lprintf("snapshot: postGCAction_everywhere\n");
     postGCAction_everywhere(false); // With object table, may have moved things
 
@@ -2678,7 +2709,7 @@ void Squeak_Interpreter::commonReturn(Oop localCntx, Oop localVal) {
 void Squeak_Interpreter::cannotReturn(Oop resultObj, bool b1, bool b2, bool b3) {
 
   lprintf("cannotReturn %d %d %d\n", b1, b2, b3);
-  lprintf("this ctx object is 0x%x\n", (Object*)activeContext_obj());
+  lprintf("this ctx object is %p\n", (Object*)activeContext_obj());
   // fatal("internal cannot return");
 
   push(activeContext());
@@ -2750,6 +2781,8 @@ Object_p Squeak_Interpreter::allocateOrRecycleContext(bool needsLarge) {
       Oop fc = r->fetchPointer(Object_Indices::Free_Chain_Index);
       assert(fc.is_mem()  ||  fc == Object::NilContext());
       freeC = fc;
+      if (The_Memory_System()->is_marking_concurrently())
+        r->mark_atomically_without_store_barrier(); // as good as new, see Abstract_Mark_Sweep_Collector::start_concurrent_mark
       assert(The_Memory_System()->contains(r));
       // assert_eq(r->rank(), my_rank, "");
       if (check_many_assertions  &&  r->get_count_of_blocks_homed_to_this_method_ctx() > 0)
@@ -2986,7 +3019,7 @@ void Squeak_Interpreter::check_method_is_correct(bool will_be_fetched, const cha
     return;
   else if (!(0 <= litx  &&  litx < m->literalCount()))
     msg = "literal index out of bounds";
-  else if (!(lit = literal(litx)).is_int()  &&  !The_Memory_System()->object_table->probably_contains((void*)lit.bits()))
+  else if (!(lit = literal(litx)).is_int()  &&  !The_Memory_System()->object_table->probably_contains_oop(lit))
     msg = "bad mem literal";
   else
     return;
@@ -2994,8 +3027,8 @@ void Squeak_Interpreter::check_method_is_correct(bool will_be_fetched, const cha
   error_printer->printf("on %d: check_method_is_correct: %s, will_be_fetched %d, instructionPointer - method %d, "
                         "bcp - method %d, *bcp %d, litx %d, literalCount %d, lit 0x%x, nbytes %d, at %s\nmethod: ",
                         my_rank(), msg, will_be_fetched,
-                        instructionPointer() - m->as_u_char_p(), bcp - m->as_u_char_p(),
-                        *bcp, litx, m->literalCount(), lit.bits(), m->lengthOf() - sizeof(Oop),
+                        int(instructionPointer() - m->as_u_char_p()), int(bcp - m->as_u_char_p()),
+                        *bcp, litx, m->literalCount(), lit.bits(), int(m->lengthOf() - sizeof(Oop)),
                         where);
   m->print_compiled_method(error_printer);
   error_printer->nl();
@@ -3042,8 +3075,8 @@ void Squeak_Interpreter::receive_initial_interpreter_from_main(Squeak_Interprete
   
   memcpy(this, sq, sizeof(Squeak_Interpreter)); // initalize with copy; use memcpy to avoid complains about consts, was: *this = *sq;
  
-  void* const rankAddr = (void* const)&this->_my_rank;
-  void* const coreAddr = (void* const)&this->_my_core;
+  void* const rankAddr = (void*)&this->_my_rank;
+  void* const coreAddr = (void*)&this->_my_core;
   *((int*)rankAddr)           = my_rank;
   *((Logical_Core**)coreAddr) = my_core;
 #endif
@@ -3060,7 +3093,7 @@ void Squeak_Interpreter::receive_initial_interpreter_from_main(Squeak_Interprete
 }
 
 void Squeak_Interpreter::print_method_info(const char* msg) {
-  error_printer->printf("%d on %d: %s, process_is_scheduled_and_executing %d, method 0x%x, method_obj 0x%x, instructionPointer 0x%x, activeContext_obj() 0x%x, activeContext().as_object() 0x%x, freeContexts 0x%x\n",
+  error_printer->printf("%d on %d: %s, process_is_scheduled_and_executing %d, method 0x%x, method_obj %p, instructionPointer %p, activeContext_obj() %p, activeContext().as_object() %p, freeContexts 0x%x\n",
                         increment_print_sequence_number(),
                         my_rank(), msg, process_is_scheduled_and_executing(), method().bits(), (Object*)method_obj(), instructionPointer(),
                         (Object*)activeContext_obj(), activeContext().as_untracked_object_ptr(),
@@ -3099,6 +3132,11 @@ void Squeak_Interpreter::print_stack_frame() {
 }
 
 
+void Squeak_Interpreter::scan_activated_context_for_concurrent_mark() {
+  Abstract_Mark_Sweep_Collector::scan_context_being_activated(activeContext_obj(), theHomeContext_obj());
+}
+
+
 void Squeak_Interpreter::preGCAction_here(bool fullGC) {
   if (check_many_assertions) activeContext_obj()->check_all_IPs_in_chain();
   const bool print = false;
@@ -378,6 +378,7 @@ public:
   void loadInitialContext();
   void initialCleanup();
 
+  void scan_activated_context_for_concurrent_mark();
   void fetchContextRegisters(Oop activeCntx, Object_p activeCntx_obj) {
     assert(activeCntx_obj->as_oop() == activeCntx);
     
@@ -388,6 +389,9 @@ public:
                        ? activeCntx_obj->fetchPointer(Object_Indices::HomeIndex).beRootIfOld()
                        : activeCntx);
     
+    if (The_Memory_System()->is_marking_concurrently())
+      scan_activated_context_for_concurrent_mark();
+
     roots.receiver = theHomeContext_obj()->fetchPointer(Object_Indices::ReceiverIndex);
     set_method(theHomeContext_obj()->fetchPointer(Object_Indices::MethodIndex));
 
@@ -415,7 +419,7 @@ public:
       dittoing_stdout_printer->printf(", method: ");
       method().print(dittoing_stdout_printer);
       dittoing_stdout_printer->printf(", IP %d, SP %d\n", ip_int, sp_int);
-      dittoing_stdout_printer->printf("  instructionPointer 0x%x, stackPointer 0x%x\n",
+      dittoing_stdout_printer->printf("  instructionPointer %p, stackPointer %p\n",
                                       _instructionPointer, _stackPointer);
     }
   }
@@ -873,7 +877,7 @@ public:
         Oop m = methodArray_obj->fetchPointer(i - Object_Indices::SelectorStart);
         m.print(dittoing_stdout_printer);
         if (m.as_object()->isCompiledMethod()) {
-          dittoing_stdout_printer->printf(", Obj 0x%x, firstByte: %d", (Object*)m.as_object(),
+          dittoing_stdout_printer->printf(", Obj %p, firstByte: %d", (Object*)m.as_object(),
                                           *(u_char*)(m.as_object()->first_byte_address()));
         }
         dittoing_stdout_printer->nl();
@@ -1169,7 +1173,7 @@ public:
     oopcpy_no_store_check(toObj->as_oop_p() + firstTo + offset,  fromObj->as_oop_p() + firstFrom + offset, count, toObj);
   }
 
-  void snapshot(bool);
+  void snapshot(bool embedded, int background_semaphore_index = -1);
   void snapshotCleanUp();
 
   void     displayBitsOf(Oop, oop_int_t, oop_int_t, oop_int_t, oop_int_t);
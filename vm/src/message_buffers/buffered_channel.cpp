@@ -21,10 +21,14 @@ void BufferedChannel::initialize(size_t numberOfBuffers, size_t sizeOfSingleBuff
   syncedqueue_initialize(&waiting_list, (int32_t*)waiting_list_buffer, numberOfBuffers);
   syncedqueue_initialize(&used_list, (int32_t*)used_list_buffer, numberOfBuffers);
 
-  for (size_t i = 0; i < numberOfBuffers; i++) {
-    int32_t buffer_address = int32_t(buffer_memory) + i * (sizeOfSingleBuffer + sizeof(buffer));
-    syncedqueue_enqueue(&free_list, &buffer_address, 1);
-  }
+  // the queues hold buffer indices, pointers do not fit into their int32_t entries on 64-bit hosts
+  for (int32_t i = 0; i < int32_t(numberOfBuffers); i++)
+    syncedqueue_enqueue(&free_list, &i, 1);
+}
+
+BufferedChannel::buffer* BufferedChannel::buffer_at(int32_t index) {
+  assert(0 <= index  &&  size_t(index) < num_buffers);
+  return (buffer*)((char*)buffer_memory + index * (size_of_single_buffer + sizeof(buffer)));
 }
 
 void BufferedChannel::send(const void* data, size_t size) {
@@ -32,25 +36,28 @@ void BufferedChannel::send(const void* data, size_t size) {
   assert(size <= size_of_single_buffer);
 
   // aquire buffer
-  buffer* buffer;
-  syncedqueue_dequeue(&free_list, (int32_t*)&buffer, 1);
+  int32_t index;
+  syncedqueue_dequeue(&free_list, &index, 1);
+  buffer* buffer = buffer_at(index);
 
   // copy data to buffer
   memcpy(buffer->buffer, data, size);
   buffer->used = size;
 
   // put buffer into used list
-  syncedqueue_enqueue(&waiting_list, (int32_t*)&buffer, 1);
+  syncedqueue_enqueue(&waiting_list, &index, 1);
 }
 
 const void* BufferedChannel::receive(size_t& size) {
-  buffer* buffer;
+  int32_t index;
 
   // block until data available
-  syncedqueue_dequeue(&waiting_list, (int32_t*)&buffer, 1);
+  syncedqueue_dequeue(&waiting_list, &index, 1);
 
   // put into used list
-  syncedqueue_enqueue(&used_list, (int32_t*)&buffer, 1);
+  syncedqueue_enqueue(&used_list, &index, 1);
+
+  buffer* buffer = buffer_at(index);
 
   size = buffer->used;
   return (const void*)buffer->buffer;
@@ -58,16 +65,17 @@ const void* BufferedChannel::receive(size_t& size) {
 
 void BufferedChannel::releaseOldest(void* buffer_to_be_released_for_debugging) {
   // get latest used buffer
-  buffer* buffer;
+  int32_t index;
 
-  syncedqueue_dequeue(&used_list, (int32_t*)&buffer, 1);
+  syncedqueue_dequeue(&used_list, &index, 1);
+  buffer* buffer = buffer_at(index);
   assert((void*)buffer->buffer == buffer_to_be_released_for_debugging);
 
   // set used to 0
   buffer->used = 0;
 
   // enqueue to free list
-  syncedqueue_enqueue(&free_list, (int32_t*)&buffer, 1);
+  syncedqueue_enqueue(&free_list, &index, 1);
 }
 
 bool BufferedChannel::hasData() {
@@ -37,6 +37,7 @@ private:
   const void* used_list_buffer;
 
   void initialize(size_t numberOfBuffers, size_t sizeOfSingleBuffer);
+  buffer* buffer_at(int32_t index);
 
 public:
   BufferedChannel(size_t numberOfBuffers, size_t sizeOfSingleBuffer)
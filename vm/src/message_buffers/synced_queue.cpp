@@ -22,7 +22,8 @@
 #include "synced_queue.h"
 
 # ifndef __APPLE__
-  # define pthread_yield_np pthread_yield
+  # include <sched.h>
+  # define pthread_yield_np sched_yield // pthread_yield is deprecated
 # endif
 
 void syncedqueue_initialize(p_syncedqueue sq, int32_t* const buffer, size_t item_count) {
@@ -62,7 +62,7 @@ void Deferred_Request::print_all_messages(int rank) {
   if (  sizeof(first_request) / sizeof(first_request[0])    == 1  &&  Logical_Core::num_cores > 1)
     fatal("cannot possibly work, need shared memory");
   for (Deferred_Request* r = first_request[rank];  r != NULL;  r = r->next) {
-    lprintf("printing 0x%x\n", r);
+    lprintf("printing %p\n", r);
     r->print();
   }
 }
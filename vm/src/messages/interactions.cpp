@@ -74,12 +74,12 @@ Object* Interactions::add_object_from_snapshot_allocating_chunk(int dst, Oop dst
   }
   const bool verbose = false;
   if (verbose)
-    lprintf("sending add_object_from_snapshot_allocating_chunk to %d, dst 0x%x, src 0x%x\n", dst, dst_oop.bits(), src_obj_wo_preheader);
+    lprintf("sending add_object_from_snapshot_allocating_chunk to %d, dst 0x%x, src %p\n", dst, dst_oop.bits(), src_obj_wo_preheader);
 
   SEND_THEN_WAIT_AND_RETURN_MESSAGE(addObjectFromSnapshotMessage_class(dst_oop, src_obj_wo_preheader), dst,
                                     addObjectFromSnapshotResponse, r);
   if (verbose)
-    lprintf("returned add_object_from_snapshot_allocating_chunk from %d, dst 0x%x\n", dst, r.dst_obj);
+    lprintf("returned add_object_from_snapshot_allocating_chunk from %d, dst %p\n", dst, r.dst_obj);
 
   return r.dst_obj;
 }
@@ -92,7 +92,7 @@ static void run_primitive_print(fn_t f, const char* long_msg, const char* short_
   if (The_Squeak_Interpreter()->get_global_sequence_number() > 20)
     fprintf(stderr, "%s", short_msg);
   else
-    lprintf("%s send of a primitive 0x%x %d\n", long_msg, f,
+    lprintf("%s send of a primitive %p %d\n", long_msg, f,
             The_Squeak_Interpreter()->increment_global_sequence_number());
 }
 
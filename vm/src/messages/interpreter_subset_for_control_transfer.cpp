@@ -23,6 +23,12 @@ void Interpreter_Subset_For_Control_Transfer::set_from_interpreter() {
 # define SET_FROM(type, my_var, in_var) my_var = The_Squeak_Interpreter()->in_var;
   FOR_ALL_VARS_IN_SUBSET(SET_FROM)
 # undef SET_FROM
+
+  if (Memory_System::is_using_nurseries()) {
+    // the other side will run with these, see Nursery
+    Publish_Closure pc;
+    do_all_roots(&pc);
+  }
 }
 
 
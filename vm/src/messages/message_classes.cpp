@@ -30,8 +30,8 @@ void updateEnoughInterpreterToTransferControlMessage_class::send_to(int r) {
 
 void  aboutToWriteReadMostlyMemoryMessage_class::handle_me() {
   if (!The_Memory_System()->contains(addr) && !The_Memory_System()->object_table->probably_contains(addr)) {
-    lprintf("%d about to do bad remote invalidate %d (%s) 0x%x (%s) 0x%x\n",
-            getpid(), sender, Message_Statics::message_names[sender], addr, Message_Statics::message_names[(int)addr], nbytes);
+    lprintf("%d about to do bad remote invalidate %d (%s) %p (%s) 0x%x\n",
+            getpid(), sender, Message_Statics::message_names[sender], addr, Message_Statics::message_names[(intptr_t)addr], nbytes);
     OS_Interface::die("bad remote invalidate");
   }
   OS_Interface::invalidate_mem(addr, nbytes);
@@ -128,6 +128,10 @@ void enforceCoherenceBeforeSenderStoresIntoAllHeapsMessage_class::handle_me() {
 
 
 
+void finishLazySweepMessage_class::handle_me() {
+  The_Memory_System()->finish_lazy_sweep_here();
+}
+
 void flushFreeContextsMessage_class::handle_me() {
   The_Squeak_Interpreter()->roots.flush_freeContexts();
 }
@@ -243,7 +247,7 @@ void runPrimitiveMessage_class::handle_me() {
   static const bool verbose = false;
 
   if (verbose) {
-    lprintf("handling runPrimitiveMessage from %d for 0x%x %d\n", sender, fn,
+    lprintf("handling runPrimitiveMessage from %d for %p %d\n", sender, fn,
             The_Squeak_Interpreter()->increment_global_sequence_number());
   }
 
@@ -272,13 +276,13 @@ void runPrimitiveMessage_class::handle_me() {
   The_Squeak_Interpreter()->run_primitive_on_main_from_elsewhere(fn);
 
   if (verbose) {
-    lprintf("sending runPrimitiveResponse 0x%x %d\n", fn,
+    lprintf("sending runPrimitiveResponse %p %d\n", fn,
             The_Squeak_Interpreter()->increment_global_sequence_number());
   }
   runPrimitiveResponse_class().send_to(sender);
 
   if (verbose) {
-    lprintf("sent runPrimitiveResponse 0x%x %d\n", fn,
+    lprintf("sent runPrimitiveResponse %p %d\n", fn,
             The_Squeak_Interpreter()->increment_global_sequence_number());
   }
 
@@ -304,6 +308,8 @@ void runPrimitiveResponse_class::handle_me() {
 
 void sampleOneCoreMessage_class::handle_me() { 
   Oop sample = sample_one_core(what_to_sample);
+  if (Memory_System::is_using_nurseries())
+    The_Memory_System()->my_nursery()->publish(sample);
   The_Squeak_Interpreter()->pushRemappableOop(sample); // could GC while msg in transit
   sampleOneCoreResponse_class(sample).send_to(sender);   
   The_Squeak_Interpreter()->popRemappableOop();
@@ -314,11 +320,26 @@ void sampleOneCoreResponse_class::handle_me() {
 }
 
 
+void parallelHeapScanMessage_class::handle_me() {
+  scan->help();
+}
+
+
+void parallelMarkMessage_class::handle_me() {
+  Mark_Sweep_Collector helper;
+  helper.mark_as_parallel_helper(pool);
+}
+
+
 void scanCompactOrMakeFreeObjectsMessage_class::handle_me() {
   The_Memory_System()->scan_compact_or_make_free_objects_here(compacting, gc_or_null);
 }
 
 
+void startConcurrentMarkMessage_class::handle_me() {
+  Abstract_Mark_Sweep_Collector::start_concurrent_mark_here(pool);
+}
+
 void startInterpretingMessage_class::handle_me() {}
 
 void transferControlMessage_class::handle_me() {
@@ -341,6 +362,8 @@ void verifyInterpreterAndHeapMessage_class::handle_me() {
   The_Squeak_Interpreter()->verify();
   The_Memory_System()->heaps[Logical_Core::my_rank()][Memory_System::read_mostly]->verify();
   The_Memory_System()->heaps[Logical_Core::my_rank()][Memory_System:: read_write]->verify();
+  if (Memory_System::is_using_nurseries())
+    The_Memory_System()->my_nursery()->verify();
 }
 
 
@@ -118,7 +118,7 @@ size_t Message_Statics::max_message_size() {
 }
 
 // Used only for debugging and optimizing message buffer sizes
-# define PRINT_SIZE(name, superclass, formals, args, ctor_body, body, ack, safepoint_delay_setting) lprintf("MsgClass %s has size %d\n", #name, sizeof(name##_class)); 
+# define PRINT_SIZE(name, superclass, formals, args, ctor_body, body, ack, safepoint_delay_setting) lprintf("MsgClass %s has size %d\n", #name, int(sizeof(name##_class))); 
 void Message_Statics::print_size() {
   FOR_ALL_MESSAGES_DO(PRINT_SIZE);
 }
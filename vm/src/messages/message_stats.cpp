@@ -14,7 +14,7 @@
 
 #include "headers.h"
 
-Message_Stats::statistics Message_Stats::stats[Memory_Semantics::max_num_threads_on_threads_or_1_on_processes] = { 0 };
+Message_Stats::statistics Message_Stats::stats[Memory_Semantics::max_num_threads_on_threads_or_1_on_processes] = {};
 
 Oop Message_Stats::get_stats(int what_to_sample) {
   int rank_on_threads_or_zero_on_processes = Memory_Semantics::rank_on_threads_or_zero_on_processes();
@@ -45,6 +45,7 @@ template(selfDestructMessage,abstractMessage, (const char* w), (), {why = w;}, c
 template(enforceCoherenceAfterEachCoreHasStoredIntoItsOwnHeapMessage,abstractMessage, (), (), , , post_ack_for_correctness, dont_delay_when_have_acquired_safepoint) \
 template(enforceCoherenceBeforeEachCoreStoresIntoItsOwnHeapMessage,abstractMessage, (), (), , , post_ack_for_correctness, dont_delay_when_have_acquired_safepoint) \
 template(enforceCoherenceBeforeSenderStoresIntoAllHeapsMessage,abstractMessage, (), (), , , post_ack_for_correctness, dont_delay_when_have_acquired_safepoint) \
+template(finishLazySweepMessage,abstractMessage, (), (), , , post_ack_for_correctness, dont_delay_when_have_acquired_safepoint) \
 template(flushFreeContextsMessage,abstractMessage, (), (), , , post_ack_for_correctness, dont_delay_when_have_acquired_safepoint) /* xxxxxx could be simple if no waiting */\
 \
 template(flushInterpreterCachesMessage,abstractMessage, (), (), , , no_ack, dont_delay_when_have_acquired_safepoint) \
@@ -65,6 +66,8 @@ template(loadFunctionFromPluginResponse,abstractMessage, (fn_t f), (), { fn = f;
 template(newValueForOopMessage,abstractMessage, (Oop x, Oop*p), (), {addr = p; newValue = x;}, Oop* addr; Oop newValue; void do_all_roots(Oop_Closure*);, no_ack, dont_delay_when_have_acquired_safepoint) \
 \
 template(noMoreRootsResponse,abstractMessage, (), (), , , no_ack, dont_delay_when_have_acquired_safepoint)  \
+template(parallelHeapScanMessage,abstractMessage, (Parallel_Heap_Scan* s), (), {scan = s;}, Parallel_Heap_Scan* scan;, no_ack, dont_delay_when_have_acquired_safepoint) \
+template(parallelMarkMessage,abstractMessage, (Parallel_Mark_Work_Pool* p), (), {pool = p;}, Parallel_Mark_Work_Pool* pool;, no_ack, dont_delay_when_have_acquired_safepoint) \
 template(postGCActionMessage,abstractMessage, (bool f, bool is_a), (), {fullGC = f; sender_is_able_to_safepoint = is_a; }, bool fullGC; bool sender_is_able_to_safepoint; , no_ack, dont_delay_when_have_acquired_safepoint) \
 template(preGCActionMessage,abstractMessage, (bool f), (), {fullGC = f;}, bool fullGC;, post_ack_for_correctness, dont_delay_when_have_acquired_safepoint) \
 template(recycleContextIfPossibleMessage,abstractMessage, (Oop c), (), {ctx = c;}, Oop ctx; void do_all_roots(Oop_Closure*); , no_ack, dont_delay_when_have_acquired_safepoint) \
@@ -86,6 +89,7 @@ template(tellCoreIAmSpinningMessage,abstractMessage, (int sn, bool was), (), {se
 template(sampleOneCoreMessage,abstractMessage, (int w), (), {what_to_sample = w;}, int what_to_sample;, no_ack, delay_when_have_acquired_safepoint) \
 template(sampleOneCoreResponse,abstractMessage, (Oop r), (), {result = r;}, Oop result;  void do_all_roots(Oop_Closure*);, post_ack_for_correctness, dont_delay_when_have_acquired_safepoint) \
 template(scanCompactOrMakeFreeObjectsMessage,abstractMessage, (bool c, Abstract_Mark_Sweep_Collector* g), (), {compacting = c; gc_or_null = g;}, bool compacting; Abstract_Mark_Sweep_Collector* gc_or_null; , post_ack_for_correctness, dont_delay_when_have_acquired_safepoint) \
+template(startConcurrentMarkMessage,abstractMessage, (Parallel_Mark_Work_Pool* p), (), {pool = p;}, Parallel_Mark_Work_Pool* pool;, post_ack_for_correctness, dont_delay_when_have_acquired_safepoint) \
 template(startInterpretingMessage,abstractMessage, (), (), , , no_ack, dont_delay_when_have_acquired_safepoint) \
 template(verifyInterpreterAndHeapMessage,abstractMessage, (), (), , , post_ack_for_correctness, dont_delay_when_have_acquired_safepoint) \
 template(zapUnusedPortionOfHeapMessage,abstractMessage, (), (), , , post_ack_for_correctness, dont_delay_when_have_acquired_safepoint) \
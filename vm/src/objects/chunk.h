@@ -61,5 +61,6 @@ class Chunk
   }
 
   void make_free_object(oop_int_t bytes_including_header, int id);
+  void set_free_object_header(oop_int_t bytes_including_header);
 };
 
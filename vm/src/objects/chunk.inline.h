@@ -21,10 +21,7 @@ inline void Chunk::make_free_object(oop_int_t bytes_including_header, int id) {
   // skip over the preheader and initialize it later properly
   Object* const first_object_header_word = (Object*)((char*)this + preheader_byte_size);
   
-  oop_int_t contents = Object::make_free_object_header(bytes_excluding_preheader);
-  
-  DEBUG_STORE_CHECK((oop_int_t*)first_object_header_word, contents);  
-  *(oop_int_t*)first_object_header_word = contents;
+  set_free_object_header(bytes_including_header);
   
   // only used by GC and IT worries about coherence
   if (check_assertions) {
@@ -36,3 +33,11 @@ inline void Chunk::make_free_object(oop_int_t bytes_including_header, int id) {
   }
 }
 
+
+// Just the header, when the rest is known to be free already
+inline void Chunk::set_free_object_header(oop_int_t bytes_including_header) {
+  oop_int_t* const first_object_header_word = (oop_int_t*)((char*)this + preheader_byte_size);
+  oop_int_t contents = Object::make_free_object_header(bytes_including_header - preheader_byte_size);
+  DEBUG_STORE_CHECK(first_object_header_word, contents);
+  *first_object_header_word = contents;
+}
@@ -161,7 +161,7 @@ void Object::print_compiled_method(Printer* p) {
   for (size_t i = 0;  i < byteSize() - sizeof(oop_int_t);  ++i) {
     u_char* bcp = (u_char*)&first_byte_address()[i];
     u_char bc = *bcp;
-    p->printf("0x%x: byte %d: %d %s\n", bcp, i,  bc, Squeak_Interpreter::bytecode_name(bc));
+    p->printf("%p: byte %d: %d %s\n", bcp, int(i),  bc, Squeak_Interpreter::bytecode_name(bc));
   }
   p->nl();
 }
@@ -175,7 +175,7 @@ Oop Object::className() const {
 
 Oop Object::name_of_class_or_metaclass(bool* is_meta) const {
   Oop cn = className();
-  if (!cn.is_mem()  ||  !The_Memory_System()->object_table->probably_contains((void*)cn.bits())  ||  !The_Memory_System()->contains(cn.as_object()))
+  if (!cn.is_mem()  ||  !The_Memory_System()->object_table->probably_contains_oop(cn)  ||  !The_Memory_System()->contains(cn.as_object()))
     return The_Squeak_Interpreter()->roots.nilObj;
   return (*is_meta = !(cn.bits() != 0  && cn.isBytes()))
     ? fetchPointer(Object_Indices::This_Class_Index).as_object()->className()
@@ -344,7 +344,7 @@ bool Object::okayOop() {
   // "Verify that the given oop is legitimate. Check address, header, and size but not class."
 
   // address and size checks
-  Abstract_Object_Heap* h = my_heap();
+  Abstract_Object_Heap* h = The_Memory_System()->space_containing(this);
   bool ok = h->contains(this)  &&  h->contains(&as_char_p()[sizeBits()-1]);
 
   assert_always_msg( ok, "oop not in heap or size would extend beyond end of memory");
@@ -356,7 +356,7 @@ bool Object::okayOop() {
 
       case Header_Type::Short:
         if ( compact_class_index() == 0 ) {
-            lprintf("found zero compact class field in short header: Oop 0x%x, Object_p 0x%x\n",
+            lprintf("found zero compact class field in short header: Oop 0x%x, Object_p %p\n",
                     as_oop().bits(), this);
             fatal("cannot have zero compact class field in a short header");
         }
@@ -533,6 +533,8 @@ Oop Object::clone() {
                                               newObj);
 
   The_Memory_System()->object_table->allocate_oop_and_set_preheader(newObj, Logical_Core::my_rank()  COMMA_TRUE_OR_NOTHING);
+  if (The_Memory_System()->is_marking_concurrently())
+    newObj->mark_without_store_barrier(); // allocate black
   
 # if Extra_Preheader_Word_Experiment
   oop_int_t ew = remappedObject->get_extra_preheader_word();
@@ -540,7 +542,7 @@ Oop Object::clone() {
   newObj->set_extra_preheader_word(ew);
 # endif
   
-  // newObj->beRootIfOld();
+  newObj->beRootIfOld(); // the copy skipped the barrier
   
   return newObj->as_oop();
 }
@@ -770,7 +772,7 @@ void Object::print_process_or_nil(Printer* p, bool print_stack) {
   
   Oop name = name_of_process();
   if (name != The_Squeak_Interpreter()->roots.nilObj) {
-    p->printf("name: "); name.as_object()->print_bytes(p); p->printf("0x%x  ", name.as_object()->first_byte_address());
+    p->printf("name: "); name.as_object()->print_bytes(p); p->printf("%p  ", name.as_object()->first_byte_address());
     //if (strncasecmp(name.as_object()->first_byte_address(), "ScreenController", 16) == 0) {
     //  print_stack = true;
     //}    
@@ -819,7 +821,7 @@ void Object::print_frame(Printer* p) {
     fetchInteger(Object_Indices::InstructionPointerIndex)
       - ((Object_Indices::LiteralStart + mo->literalCount() * bytesPerWord) + 1);
 
-  p->printf("0x%x, ip %3d, sp %2d:  ", this, ip, sp);
+  p->printf("%p, ip %3d, sp %2d:  ", this, ip, sp);
 
 
   Oop sel, mclass;
@@ -830,7 +832,7 @@ void Object::print_frame(Printer* p) {
       mclass = rcvr.fetchClass();
 
     p->printf(" "); rcvr.print(p);
-    if (rcvr.is_mem()) p->printf("<0x%x>", rcvr.as_untracked_object_ptr());
+    if (rcvr.is_mem()) p->printf("<%p>", rcvr.as_untracked_object_ptr());
     if (mclass.as_object() != klass) {
       p->printf("(");
       bool is_meta;
@@ -866,7 +868,7 @@ bool Object::selector_and_class_of_method_in_me_or_ancestors(Oop method, Oop* se
   }
   Object_p mo = method.as_object();
   if (!The_Memory_System()->contains(mo)) {
-    lprintf( "selector_and_class_of_method_in_me_or_ancestors: method 0x%x is not in heap\n", (Object*)mo);
+    lprintf( "selector_and_class_of_method_in_me_or_ancestors: method %p is not in heap\n", (Object*)mo);
     return false;
   }
   Oop    methodDictOop = fetchPointer(Object_Indices::MessageDictionaryIndex);
@@ -876,7 +878,7 @@ bool Object::selector_and_class_of_method_in_me_or_ancestors(Oop method, Oop* se
   }
   Object_p methodDict = methodDictOop.as_object();
   if (!The_Memory_System()->contains(methodDict)) {
-    lprintf( "selector_and_class_of_method_in_me_or_ancestors: methodDict 0x%x is not in heap\n", (Object*)methodDict);
+    lprintf( "selector_and_class_of_method_in_me_or_ancestors: methodDict %p is not in heap\n", (Object*)methodDict);
     return false;
   }
   Oop sel = methodDict->key_at_identity_value(method);
@@ -890,7 +892,7 @@ bool Object::selector_and_class_of_method_in_me_or_ancestors(Oop method, Oop* se
     static bool warned = false; // Stefan: is set only once, thus it is threadsafe
     if (!warned) {
       warned = true;
-      lprintf( "selector_and_class_of_method_in_me_or_ancestors: did not find method 0x%x in class 0x%x\n",
+      lprintf( "selector_and_class_of_method_in_me_or_ancestors: did not find method %p in class %p\n",
               (Object*)mo,  this);
     }
     return false;
@@ -901,7 +903,7 @@ bool Object::selector_and_class_of_method_in_me_or_ancestors(Oop method, Oop* se
 
 Oop Object::key_at_identity_value(Oop val) {
   if (!isPointers())
-    lprintf("key_at_identity_value: this is pointers 0x%x\n", this);
+    lprintf("key_at_identity_value: this is pointers %p\n", this);
 
   else {
 
@@ -956,6 +958,8 @@ void Object::move_to_heap(int r, int rw_or_rm, bool do_sync) {
   Safepoint_Ability sa(false);
 
   Oop oop = as_oop();
+  if (Memory_System::is_using_nurseries())
+    The_Memory_System()->my_nursery()->publish(oop); // other cores will see it
   if (do_sync) {
     The_Squeak_Interpreter()->preGCAction_everywhere(false);  // false because caches are oop-based, and we just move objs
     flushFreeContextsMessage_class().send_to_all_cores(); // might move a free context, then it would not be in right place
@@ -974,16 +978,38 @@ void Object::move_to_heap(int r, int rw_or_rm, bool do_sync) {
   DEBUG_MULTIMOVE_CHECK(dst_chunk, src_chunk, (ehb + bnc) / bytes_per_oop );
   bcopy(src_chunk, dst_chunk, ehb + bnc);
   
-  // update the oop entry in the OT and set backpointer
-  // setting the backpointer is redundant but this routine does the safepoint
-  new_obj->set_object_address_and_backpointer(oop  COMMA_TRUE_OR_NOTHING);
+  if (Omit_Object_Table) {
+    // the references still lead to the old copy, which leads on to the new one till they are forwarded
+    new_obj->set_forwarding_backpointer(new_obj->as_oop());
+    set_forwarding_backpointer(new_obj->as_oop());
+  }
+  else {
+    // update the oop entry in the OT and set backpointer
+    // setting the backpointer is redundant but this routine does the safepoint
+    new_obj->set_object_address_and_backpointer(oop  COMMA_TRUE_OR_NOTHING);
+  }
   // this is also redundant, depending on the logic behind set_extra_preheader_word
   if (Extra_Preheader_Word_Experiment)
     new_obj->set_extra_preheader_word(get_extra_preheader_word());
   
   h->enforce_coherence_after_store(dst_chunk, ehb + bnc);
 
-  ((Chunk*)src_chunk)->make_free_object(ehb + bnc, 2); // without this GC screws up
+  // a concurrent marker may hold the old copy on its stack, and will skip it once it is free
+  if (The_Memory_System()->is_marking_concurrently()) {
+    if (Memory_System::use_mark_bitmap  &&  is_marked()) { // the mark does not come along with the header
+      new_obj->mark_without_store_barrier();
+      unmark_without_store_barrier();
+    }
+    Abstract_Mark_Sweep_Collector::regrey_moved_object(new_obj);
+  }
+
+  if (!Omit_Object_Table)
+    ((Chunk*)src_chunk)->make_free_object(ehb + bnc, 2); // without this GC screws up
+  else {
+    The_Memory_System()->remember_moved_object_copy((Chunk*)src_chunk, ehb + bnc);
+    if (do_sync)
+      The_Memory_System()->forward_moved_objects();
+  }
 
   if (do_sync) The_Squeak_Interpreter()->postGCAction_everywhere(false);
 }
@@ -1048,7 +1074,7 @@ void Object::check_IP_of_method(u_char* bcp, Object_p ctx) {
   u_char* past_bc =  (u_char*)nextChunk();
 
   if (bcp < first_bc) {
-    lprintf("bcp 0x%x < first_bc 0x%x:  past_bc 0x%x, method header 0x%x, at 0x%x, sizeBits: 0x%x, isBlock %d, ctx obj 0x%x\n",
+    lprintf("bcp %p < first_bc %p:  past_bc %p, method header 0x%x, at %p, sizeBits: 0x%x, isBlock %d, ctx obj %p\n",
             bcp, first_bc, past_bc, *as_oop_int_p(), this, sizeBits(), !ctx->isMethodContext(), (Object*)ctx);
     fatal("bcp < first_bc");
   }
@@ -1057,7 +1083,7 @@ void Object::check_IP_of_method(u_char* bcp, Object_p ctx) {
     Oop curr_meth = as_oop();
     Object* orig_home = ctx->get_orig_block_home();
     Oop curr_home = ctx->fetchPointer(Object_Indices::HomeIndex);
-    lprintf("past_bc 0x%x < bcp 0x%x:  first_bc 0x%x, method header 0x%x, at 0x%x, sizeBits: 00x%x, isBlock %d, ctx 0x%x, %s %s\n",
+    lprintf("past_bc %p < bcp %p:  first_bc %p, method header 0x%x, at %p, sizeBits: 00x%x, isBlock %d, ctx %p, %s %s\n",
             past_bc, bcp, first_bc, *as_oop_int_p(), this, sizeBits(), !ctx->isMethodContext(), (Object*)ctx,
             orig_meth == curr_meth ? "method same" : "method changed",
             orig_home == curr_home.as_untracked_object_ptr() ? "home OBJ same" : "home OBJ changed");
@@ -144,6 +144,7 @@ public:
   void set_backpointer(Oop x) {
       set_backpointer_word(backpointer_from_oop(x));
   }
+  inline void set_forwarding_backpointer(Oop x);
   void set_preheader(Oop x) { 
     init_extra_preheader_word();
       set_backpointer(x);
@@ -243,10 +244,11 @@ public:
   }
 
  public:
-  bool is_marked() { return header_is_marked(baseHeader); }
+  inline bool is_marked();
   static bool header_is_marked(int32 hdr) { return hdr & MarkBit; }
 
   inline void   mark_without_store_barrier();
+  inline bool   mark_atomically_without_store_barrier();
   inline void unmark_without_store_barrier();
 
  public:
@@ -373,7 +375,7 @@ public:
   inline char* first_byte_address() const;
   inline int32 methodHeader() const; // use instead of header()
   inline void beRootIfOld();
-  bool is_new() const { /*unimplemented();*/ return false; }
+  inline bool is_new();
 
 
   // ObjectMemory object enumeration
@@ -617,10 +619,7 @@ public:
   static oop_int_t sizeOfSTArrayFromCPrimitive(void* p);
 
   inline Multicore_Object_Heap* my_heap();
-  bool my_heap_contains_me() {
-    Multicore_Object_Heap* h = my_heap();
-    return h->contains(this);
-  }
+  inline bool my_heap_contains_me();
 
   bool is_current_copy() { return as_oop().as_object() == this; }
 
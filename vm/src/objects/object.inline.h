@@ -33,8 +33,34 @@ inline void Object::set_class_oop_no_barrier(Oop x) {
                        |  Header_Type::without_type(x.bits());
 }
 
-inline void Object::  mark_without_store_barrier() { baseHeader |=  MarkBit; }
-inline void Object::unmark_without_store_barrier() { baseHeader &= ~MarkBit; }
+// With a mark bitmap, marking leaves the header, and so the cache line and its coherence, alone.
+inline bool Object::is_marked() {
+  if (!Memory_System::use_mark_bitmap)
+    return header_is_marked(baseHeader);
+  Memory_System* ms = The_Memory_System();
+  return ms->mark_bitmap()->is_set(ms->mark_bit_index(this));
+}
+
+inline void Object::mark_without_store_barrier() {
+  if (!Memory_System::use_mark_bitmap)  baseHeader |= MarkBit;
+  else The_Memory_System()->mark_bitmap()->set(The_Memory_System()->mark_bit_index(this));
+}
+
+inline void Object::unmark_without_store_barrier() {
+  if (!Memory_System::use_mark_bitmap)  baseHeader &= ~MarkBit;
+  else The_Memory_System()->mark_bitmap()->clear(The_Memory_System()->mark_bit_index(this));
+}
+
+// Returns true if this call set the mark bit, false if another core beat us to it.
+inline bool Object::mark_atomically_without_store_barrier() {
+  if (Memory_System::use_mark_bitmap)
+    return The_Memory_System()->mark_bitmap()->set(The_Memory_System()->mark_bit_index(this));
+  for (;;) {
+    int32 h = baseHeader;
+    if (header_is_marked(h))  return false;
+    if (OS_Interface::atomic_compare_and_swap(&baseHeader, h, h | MarkBit))  return true;
+  }
+}
 
 
 
@@ -43,6 +69,12 @@ inline void Object::set_backpointer_word(oop_int_t w) {
   The_Memory_System()->store_enforcing_coherence(dst, w, (Object_p)this);
 }
 
+// Without the object table, the backpointer says where an object that is about to move will be.
+// Recording that is no mutation, so a read-mostly object is not evacuated for it.
+inline void Object::set_forwarding_backpointer(Oop x) {
+  The_Memory_System()->store_enforcing_coherence(backpointer_word(), backpointer_from_oop(x), (Object_p)NULL);
+}
+
 inline void Object::set_extra_preheader_word(oop_int_t w) {
   assert_always(w); // bug hunt qqq
   oop_int_t* dst = extra_preheader_word();
@@ -198,7 +230,7 @@ inline int Object::rightType(oop_int_t headerWord) {
 }
 
 inline void* Object::arrayValue() const {
-  return isWordsOrBytes() ? as_char_p() + BaseHeaderSize : (char*)(The_Squeak_Interpreter()->primitiveFail(), 0);
+  return isWordsOrBytes() ? as_char_p() + BaseHeaderSize : (The_Squeak_Interpreter()->primitiveFail(), (char*)NULL);
 }
 
 
@@ -355,7 +387,7 @@ inline oop_int_t Object::literalCountOfHeader(oop_int_t header) { return (header
 inline Oop Object::literal(oop_int_t offset) const {
   Oop r = fetchPointer(offset + Object_Indices::LiteralStart);
   if (check_many_assertions) {
-    assert_always(r.is_int() || The_Memory_System()->object_table->probably_contains((void*)r.bits()));
+    assert_always(r.is_int() || The_Memory_System()->object_table->probably_contains_oop(r));
   }
   return r;
 }
@@ -427,6 +459,8 @@ inline Object_p Object::fill_in_after_allocate(oop_int_t byteSize, oop_int_t hdr
   assert_eq((void*)newObj, (void*)headerp, "");
 
   The_Memory_System()->object_table->allocate_oop_and_set_preheader(newObj, my_rank  COMMA_TRUE_OR_NOTHING);
+  if (The_Memory_System()->is_marking_concurrently())
+    newObj->mark_without_store_barrier(); // allocate black
 
 
   //  "clear new object"
@@ -626,17 +660,22 @@ inline Multicore_Object_Heap* Object::my_heap() {
 }
 
 
+// a young object lives in the nursery of its heap
+inline bool Object::my_heap_contains_me() {
+  return The_Memory_System()->space_containing(this)->contains(this);
+}
+
+inline bool Object::is_new() { return The_Memory_System()->is_address_young(this); }
+
+// Called after raw stores into this object, mostly into contexts; see Nursery.
+// Unless the object is private to my nursery, it must be remembered, even if it is young on another core.
+// The young objects stored stay private, which is safe since the raw stores only go into contexts
+// and into objects just allocated: no other core can reach a new object till it is stored through the barrier,
+// nor a context but through its process, which is published when handed over. Publishing a remembered object
+// makes what it refers to escape, see Nursery::publish.
 inline void Object::beRootIfOld() {
-  if (true) return;
-#ifdef _REMEMBER_OLD_CODE // below is old code
-  unimplemented();
-  if (is_new()) return;
-  FOR_EACH_OOP_IN_OBJECT_EXCEPT_CLASS(this, oop_ptr)
-    if (oop_ptr->is_new())
-      ; // remember
-    if (contains_class_and_type_word()  &&  get_class_oop().as_object()->is_new())
-      ;
-#endif
+  if (Memory_System::is_using_nurseries())
+    The_Memory_System()->my_nursery()->remember((Object_p)this);
 }
 
 
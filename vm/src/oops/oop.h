@@ -101,7 +101,7 @@ private:
   void print_briefly(Printer*); // used for slot contents
   void dp();
 
-  bool is_new() { return false; /* unimplemented */ }
+  inline bool is_new();
 
   // ObjectMemory headerAccess
   bool isPointers();
@@ -119,7 +119,7 @@ private:
   oop_int_t slotSize();
 
   // Object Memory allocation
-  Oop beRootIfOld() { /* unimplemented */ return *this; }
+  inline Oop beRootIfOld();
 
   inline int  rank_of_object();
   inline int  mutability();
@@ -33,6 +33,13 @@ inline void oopset_no_store_check(Oop* const dst, Oop src, int n) {
   The_Memory_System()->enforce_coherence_after_store(dst, n << ShiftForWord);
 }
 
+inline bool Oop::is_new() { return is_mem()  &&  as_object()->is_new(); }
+
+inline Oop Oop::beRootIfOld() {
+  if (is_mem())  as_object()->beRootIfOld();
+  return *this;
+}
+
 inline Oop Oop::fetchClass() const {
   return is_int() ? The_Squeak_Interpreter()->splObj(Special_Indices::ClassInteger)
   : as_object()->fetchClass();
@@ -54,6 +61,8 @@ inline Oop Oop::from_object(const Object* p) {
   if (check_many_assertions)
     assert_message(p != NULL,
                    "used to count on being able to do this, fix these uses");
+  if (Omit_Object_Table)
+    return Oop::from_bits(oop_int_t(intptr_t(p)));
   return p->backpointer();
 }
 
@@ -103,7 +112,7 @@ inline oop_int_t Oop::byteSize() { return is_int() ? 0 : as_object()->byteSize()
 inline oop_int_t Oop::slotSize() { return is_int() ? 0 : as_object()->lengthOf(); }
 
 inline void* Oop::arrayValue() {
-  return is_mem() ? as_object()->arrayValue() : (void*)(The_Squeak_Interpreter()->primitiveFail(), 0);
+  return is_mem() ? as_object()->arrayValue() : (The_Squeak_Interpreter()->primitiveFail(), (void*)NULL);
 }
 
 inline int  Oop::rank_of_object()       {  return is_int()  ?  Logical_Core::my_rank()          :  The_Memory_System()->     rank_for_address(as_object()); }
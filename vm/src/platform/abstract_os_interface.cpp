@@ -14,16 +14,27 @@
 
 #include "headers.h"
 
+# if On_Intel_Linux
+#   include <sys/syscall.h>
+# endif
+
 void rvm_exit() {
   Performance_Counters::print();
   OS_Interface::exit();
 }
 
 char Abstract_OS_Interface::mmap_filename[BUFSIZ] = { 0 };
+int  Abstract_OS_Interface::heap_memfd = -1;
 
+// Once every core has mapped the heap, nobody needs to open it anymore
 void Abstract_OS_Interface::unlink_heap_file() {
   assert_always(Logical_Core::running_on_main());
-  if (mmap_filename[0]) {
+  if (heap_memfd != -1) {
+    close(heap_memfd);
+    heap_memfd = -1;
+    mmap_filename[0] = 0;
+  }
+  else if (mmap_filename[0]) {
     lprintf("Unlinked mmap_filename: %s\n", mmap_filename);
     unlink(mmap_filename);
     mmap_filename[0] = 0;
@@ -44,7 +55,14 @@ char* Abstract_OS_Interface::map_heap_memory(size_t total_size,
   
   const bool print = false;
   
-  snprintf(mmap_filename, sizeof(mmap_filename), Memory_System::use_huge_pages ? "/dev/hugetlb/rvm-%d" : "/tmp/rvm-%d", main_pid);
+  // Anonymous shared memory needs no space in /tmp and is never written back to disk.
+  // All cores, the main one included, open it through the main core's descriptor.
+  if (Logical_Core::running_on_main()  &&  heap_memfd == -1  &&  !Memory_System::use_huge_pages)
+    heap_memfd = create_anonymous_shared_file();
+  if (heap_memfd != -1)
+    snprintf(mmap_filename, sizeof(mmap_filename), "/proc/%d/fd/%d", main_pid, heap_memfd);
+  else
+    snprintf(mmap_filename, sizeof(mmap_filename), Memory_System::use_huge_pages ? "/dev/hugetlb/rvm-%d" : "/tmp/rvm-%d", main_pid);
   int open_flags = (Logical_Core::running_on_main()  ?  O_CREAT  :  0) | O_RDWR;
   
   int mmap_fd = open(mmap_filename, open_flags, 0600);
@@ -68,7 +86,8 @@ char* Abstract_OS_Interface::map_heap_memory(size_t total_size,
   
   // Cannot use MAP_ANONYMOUS below because all cores need to map the same file
   void* mmap_result = map_memory(bytes_to_map, mmap_fd, flags, where, offset,
-                                 (where == NULL) ? "object heap part (initial request)" : "object heap part");
+                                 (where == NULL) ? "object heap part (initial request)" : "object heap part",
+                                 (where == NULL) ? heap_address_hint() : NULL);
   
   if (mmap_result == MAP_FAILED) {
     char buf[BUFSIZ];
@@ -86,26 +105,94 @@ char* Abstract_OS_Interface::map_heap_memory(size_t total_size,
   close(mmap_fd);
   
   if (print)
-    lprintf("mmap(<requested address> 0x%x, <byte count to map> 0x%x, PROT_READ | PROT_WRITE, <flags> 0x%x, open(%s, 0x%x, 0600), <offset> 0x%x) returned 0x%x\n",
-            where, bytes_to_map, flags, mmap_filename, open_flags, offset, mmap_result);
+    lprintf("mmap(<requested address> %p, <byte count to map> 0x%zx, PROT_READ | PROT_WRITE, <flags> 0x%x, open(%s, 0x%x, 0600), <offset> 0x%lx) returned %p\n",
+            where, bytes_to_map, flags, mmap_filename, open_flags, long(offset), mmap_result);
  
   assert_always( mem != NULL );
   return mem;
 }
 
+// -1 if the OS has no memfd_create
+int Abstract_OS_Interface::create_anonymous_shared_file() {
+# ifdef SYS_memfd_create
+  int fd = syscall(SYS_memfd_create, "rvm-heap", 0);
+  if (fd != -1)
+    return fd;
+  perror("memfd_create, falling back to a file in /tmp");
+# endif
+  return -1;
+}
+
+// The heap is a shared mapping of a file, so dropping the pages would leave them in the page cache;
+// punch them out of the file where the OS lets us.
+void Abstract_OS_Interface::release_heap_memory(void* start, size_t bytes) {
+# ifdef MADV_REMOVE
+  if (madvise(start, bytes, MADV_REMOVE) == 0)
+    return;
+# endif
+  if (madvise(start, bytes, MADV_DONTNEED))
+    perror("madvise in release_heap_memory");
+}
+
+// Private, so only for threads; aligned so that the kernel can back it with transparent huge pages
+char* Abstract_OS_Interface::map_memory_for_transparent_huge_pages(size_t bytes, size_t alignment, void* hint) {
+  size_t padded_bytes = bytes + alignment;
+  char* mem = (char*)mmap(hint, padded_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == (char*)MAP_FAILED) {
+    perror("mmap for transparent huge pages");
+    fatal("mmap");
+  }
+  char* aligned_mem = (char*)(((uintptr_t)mem + alignment - 1) & ~(uintptr_t)(alignment - 1));
+  char* end = aligned_mem + bytes;
+  if (aligned_mem > mem)           munmap(mem, aligned_mem - mem);
+  if (mem + padded_bytes > end)    munmap(end, mem + padded_bytes - end);
+  advise_transparent_huge_pages(aligned_mem, bytes);
+  return aligned_mem;
+}
+
+// Address space only, pages are committed as they are touched
+char* Abstract_OS_Interface::reserve_memory(size_t bytes, void* hint) {
+  char* mem = (char*)mmap(hint, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mem == (char*)MAP_FAILED) {
+    perror("mmap to reserve memory");
+    fatal("mmap");
+  }
+  return mem;
+}
+
+// Pages that are only read stay shared with the page cache, written ones become private; NULL if the file cannot be mapped
+char* Abstract_OS_Interface::map_file_copy_on_write(int fd, size_t bytes) {
+  void* mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  if (mem == MAP_FAILED) {
+    perror("mmap of file");
+    return NULL;
+  }
+  if (madvise(mem, bytes, MADV_SEQUENTIAL))
+    perror("madvise(MADV_SEQUENTIAL)");
+  return (char*)mem;
+}
+
+void Abstract_OS_Interface::advise_transparent_huge_pages(void* start, size_t bytes) {
+# ifdef MADV_HUGEPAGE
+  if (madvise(start, bytes, MADV_HUGEPAGE))
+    perror("madvise(MADV_HUGEPAGE)");
+# endif
+}
+
 void* Abstract_OS_Interface::map_memory(size_t bytes_to_map,
                                         int    mmap_fd,
                                         int    flags,
                                         void*  start_address,
                                         off_t  offset_in_backing_file,
-                                        const char* const usage) {
+                                        const char* const usage,
+                                        void*  hint) {
   if (Debugging)
     lprintf("mmap: About to mmap memory for %s\n", usage);
   
   if (start_address != NULL)
     flags |= MAP_FIXED;
   
-  void* mmap_result = mmap(start_address, bytes_to_map, 
+  void* mmap_result = mmap(start_address != NULL ? start_address : hint, bytes_to_map, 
                            PROT_READ | PROT_WRITE,
                            flags, mmap_fd, offset_in_backing_file);
   
@@ -113,13 +200,13 @@ void* Abstract_OS_Interface::map_memory(size_t bytes_to_map,
     return MAP_FAILED;
 
   if (Debugging) {
-    lprintf("mmap: address requested 0x%x, result 0x%x, bytes 0x%x, flags 0x%x, offset in file 0x%x\n",
+    lprintf("mmap: address requested %p, result %p, bytes 0x%zx, flags 0x%x, offset in file 0x%x\n",
             start_address, mmap_result, bytes_to_map, flags, 0);
-    lprintf("mmap: address range %p - %p\n", mmap_result, (uintptr_t)mmap_result + bytes_to_map);
+    lprintf("mmap: address range %p - %p\n", mmap_result, (char*)mmap_result + bytes_to_map);
   }
 
   if (start_address != NULL  &&  start_address != (void*)mmap_result) {
-    lprintf("mmap asked for memory at 0x%x, but got it at 0x%x\n",
+    lprintf("mmap asked for memory at %p, but got it at %p\n",
             start_address, mmap_result);
     return MAP_FAILED;
   }
@@ -127,6 +214,14 @@ void* Abstract_OS_Interface::map_memory(size_t bytes_to_map,
   return mmap_result;
 }
 
+void Abstract_OS_Interface::check_heap_address_range(const char* start, size_t bytes) {
+  if (uint64_t(uintptr_t(start + bytes)) <= (uint64_t(1) << 31))
+    return;
+  lprintf("heap mapped at %p - %p, but the platform code needs it below 2GB; try a smaller -min_heap_MB\n",
+          start, start + bytes);
+  fatal("heap above 2GB");
+}
+
 static const char meminfo_file_name[] = "/proc/meminfo";
 static const char MemTotal[] = "MemTotal";
 
@@ -158,20 +253,45 @@ int64_t Abstract_OS_Interface::get_available_main_mem_in_kb() {
   return result;
 }
 
+static const char smaps_file_name[] = "/proc/self/smaps";
+
+// What the kernel actually backs with huge pages, anonymous or shared; -1 if it does not tell
+int64_t Abstract_OS_Interface::get_huge_page_kb_in_range(void* start, size_t bytes) {
+  FILE* f = fopen(smaps_file_name, "r");
+  if (f == NULL) { return -1; }
+  
+  uintptr_t range_start = (uintptr_t)start,  range_end = range_start + bytes;
+  bool in_range = false;
+  int64_t result = 0;
+  char line[BUFSIZ];
+  while (fgets(line, sizeof(line), f) != NULL) {
+    unsigned long map_start, map_end;
+    long kb;
+    if (sscanf(line, "%lx-%lx ", &map_start, &map_end) == 2)
+      in_range = map_start < range_end  &&  range_start < map_end;
+    else if (in_range
+         && (   sscanf(line, "AnonHugePages: %ld kB",  &kb) == 1
+             || sscanf(line, "ShmemPmdMapped: %ld kB", &kb) == 1))
+      result += kb;
+  }
+  fclose(f);
+  return result;
+}
+
 void Abstract_OS_Interface::check_requested_heap_size(size_t heap_size) {
-  size_t const max_heap_on_32bit = 3 * 1024 * Mega; // rough guess, depends a bit on the system 
+  size_t const max_heap_on_32bit = size_t(3) * 1024 * Mega; // rough guess, depends a bit on the system 
   size_t const estimate_for_other_required_memory = 580 * Mega;
   
   size_t const expected_mem_required = heap_size + estimate_for_other_required_memory;
 
-  bool might_fail = expected_mem_required > max_heap_on_32bit;
+  bool might_fail = sizeof(void*) == 4  &&  expected_mem_required > max_heap_on_32bit;
   
   if (!might_fail) {
-    might_fail = expected_mem_required > (OS_Interface::get_available_main_mem_in_kb() * 1024u);
+    might_fail = expected_mem_required > size_t(OS_Interface::get_available_main_mem_in_kb() * 1024);
   }
   
   if (might_fail)
     lprintf("WARNING! Your requested heap might be to large, and the VM might fail during startup.\n"
-            "WARNING! The required memory is about %d MB\n", expected_mem_required / Mega);
+            "WARNING! The required memory is about %d MB\n", int(expected_mem_required / Mega));
 }
 
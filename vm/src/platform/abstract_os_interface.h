@@ -48,6 +48,7 @@ public:
    * if they are equal set the new value and return true, false otherwise.
    */
   static inline bool atomic_compare_and_swap(int* /* ptr */, int /* old_value */, int /* new_value */) { fatal(); return false; }
+  static inline bool atomic_compare_and_swap(void** /* ptr */, void* /* old_value */, void* /* new_value */) { fatal(); return false; }
   
   /**
    * Atomically compare the memory location with the old value, and 
@@ -58,6 +59,7 @@ public:
   static inline int atomic_compare_and_swap_val(int* ptr, int /* old_value */, int /* new_value */) { fatal(); return *ptr; }
   
   static inline uint32_t leading_zeros   (uint32_t /* x */) { fatal(); return 0; }
+  static inline uint32_t trailing_zeros  (uint32_t /* x */) { fatal(); return 0; }
   static inline uint32_t population_count(uint32_t /* x */) { fatal(); return 0; }
   
   struct OS_Heap {};
@@ -93,6 +95,8 @@ public:
   
 protected:
   static char  mmap_filename[BUFSIZ];
+  static int   heap_memfd; // -1 unless the heap is anonymous shared memory, the number is the main core's
+  static int   create_anonymous_shared_file();
 
 public:  
   static void check_requested_heap_size(size_t heap_size);
@@ -103,10 +107,25 @@ public:
                                void* where, off_t offset,
                                int main_pid, int flags);  
   static void unlink_heap_file();
-  
+  static int  get_heap_memfd() { return heap_memfd; }
+  static void set_heap_memfd(int fd) { heap_memfd = fd; }
+  static void release_heap_memory(void* start, size_t bytes);
+  static char* map_memory_for_transparent_huge_pages(size_t bytes, size_t alignment, void* hint = NULL);
+  static char* reserve_memory(size_t bytes, void* hint = NULL);
+  static char* map_file_copy_on_write(int fd, size_t bytes);
+  static void advise_transparent_huge_pages(void* start, size_t bytes);
+  static int64_t get_huge_page_kb_in_range(void* start, size_t bytes);
+  static bool home_memory_to_core(void* /* start */, size_t /* bytes */, int32_t /* rank */) { return false; }
+  
+  // The Squeak platform code keeps object addresses in signed 32-bit sqInts, and the plugins turn those back
+  // into pointers, so on 64-bit hosts the heap is asked for below 2GB.
+  static void* heap_address_hint() { return sizeof(void*) == 8 ? (void*)0x10000000 : NULL; }
+  static void check_heap_address_range(const char* start, size_t bytes);
+
   static void* map_memory(size_t bytes_to_map, int    mmap_fd,
                           int    flags, void*  start_address,
                           off_t  offset_in_backing_file,
-                          const char* const usage);
+                          const char* const usage,
+                          void*  hint = NULL);
 
 };
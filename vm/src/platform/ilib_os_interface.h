@@ -85,6 +85,9 @@ public:
   static inline bool atomic_compare_and_swap(int* ptr, int old_value, int new_value) {
     return (0 == atomic_compare_and_exchange_bool_acq(ptr, new_value, old_value)); // Not sure whether that is stable, this API is unintuitive for me, got it wrong twice!! make sure the test cases are rerun on new lib versions
   }
+  static inline bool atomic_compare_and_swap(void** ptr, void* old_value, void* new_value) { // pointers are 32 bits here
+    return atomic_compare_and_swap((int*)ptr, (int)old_value, (int)new_value);
+  }
   
   /**
    * Atomically compare the memory location with the old value, and 
@@ -98,6 +101,7 @@ public:
   
     
   static inline uint32_t leading_zeros(uint32_t x)    { return __insn_clz(x);  }
+  static inline uint32_t trailing_zeros(uint32_t x)   { return __insn_ctz(x);  }
   static inline uint32_t population_count(uint32_t x) { return __insn_pcnt(x); }
   
 # if Use_CMem
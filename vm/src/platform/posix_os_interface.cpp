@@ -14,6 +14,11 @@
 
 #include "headers.h"
 
+# if On_Intel_Linux
+#   include <dirent.h>
+#   include <sys/syscall.h>
+# endif
+
 
 pthread_t     POSIX_OS_Interface::threads[Max_Number_Of_Cores];
 pthread_key_t POSIX_OS_Interface::rank_key = 0;
@@ -45,6 +50,67 @@ void POSIX_OS_Interface::pin_thread_to_core(int32_t rank) {
 }
 
 
+/**
+ * The Linux counterpart of homing on the Tilera: ask the kernel to keep the pages
+ * on the NUMA node of the processing unit the rank is pinned to, see above,
+ * and to move the ones that were touched from elsewhere already.
+ * Uses the system call directly to avoid depending on libnuma.
+ */
+bool POSIX_OS_Interface::home_memory_to_core(void* start, size_t bytes, int32_t rank) {
+# if On_Intel_Linux
+  static const int MPOL_PREFERRED_on_Linux = 1;
+  static const int MPOL_MF_MOVE_on_Linux   = 1 << 1;
+  static const int max_nodes = 1024;
+  
+  int node = numa_node_of_cpu(rank);
+  if (node < 0  ||  node >= max_nodes)
+    return false;
+  
+  unsigned long node_mask[max_nodes / (8 * sizeof(unsigned long))];
+  bzero(node_mask, sizeof(node_mask));
+  node_mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+  
+  if (syscall(SYS_mbind, start, bytes, MPOL_PREFERRED_on_Linux, node_mask, max_nodes, MPOL_MF_MOVE_on_Linux) != 0) {
+    static bool warned = false;
+    if (!warned)  { warned = true;  perror("mbind in home_memory_to_core"); }
+    return false;
+  }
+  return true;
+# else
+  return false;
+# endif
+}
+
+
+// -1 if the kernel does not tell
+int POSIX_OS_Interface::numa_node_of_cpu(int32_t cpu) {
+# if On_Intel_Linux
+  static int nodes[Max_Number_Of_Cores];
+  static bool looked_up[Max_Number_Of_Cores];
+  if (cpu < 0  ||  cpu >= Max_Number_Of_Cores)
+    return -1;
+  if (looked_up[cpu])
+    return nodes[cpu];
+  
+  int node = -1;
+  char dir_name[BUFSIZ];
+  snprintf(dir_name, sizeof(dir_name), "/sys/devices/system/cpu/cpu%d", cpu);
+  DIR* dir = opendir(dir_name);
+  if (dir != NULL) {
+    for (struct dirent* e;  (e = readdir(dir)) != NULL; )
+      if (sscanf(e->d_name, "node%d", &node) == 1)
+        break;
+    closedir(dir);
+  }
+  nodes[cpu] = node;
+  looked_up[cpu] = true;
+  return node;
+# else
+  return -1;
+# endif
+}
+
+
 int32_t POSIX_OS_Interface::last_rank = 0;
 
 void* POSIX_OS_Interface::pthread_thread_main(void* param) {
@@ -52,7 +118,7 @@ void* POSIX_OS_Interface::pthread_thread_main(void* param) {
 
   int32_t my_rank = __sync_add_and_fetch(&last_rank, 1);
 
-  pthread_setspecific(rank_key, (const void*)my_rank);
+  pthread_setspecific(rank_key, (const void*)intptr_t(my_rank));
 
   OS_Interface::pin_thread_to_core(my_rank);
   
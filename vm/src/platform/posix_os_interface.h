@@ -21,7 +21,8 @@
 
 # if On_Intel_Linux
   # include <sys/gmon.h>
-  # define pthread_yield_np pthread_yield
+  # include <sched.h>
+  # define pthread_yield_np sched_yield // pthread_yield is deprecated
 # endif
 
 #include <err.h>
@@ -52,7 +53,7 @@ public:
   
   typedef int get_cycle_count_quickly_t;
   # define GET_CYCLE_COUNT_QUICKLY  OS_Interface::dummy_get_cycle_count
-  # define GET_CYCLE_COUNT_QUICKLY_FMT "%ld"
+  # define GET_CYCLE_COUNT_QUICKLY_FMT "%d"
   static inline int dummy_get_cycle_count() { return 0; }
   static inline u_int64 get_cycle_count() {
     uint64_t result;
@@ -137,6 +138,9 @@ public:
   static inline bool atomic_compare_and_swap(int* ptr, int old_value, int new_value) {
     return __sync_bool_compare_and_swap(ptr, old_value, new_value);
   }
+  static inline bool atomic_compare_and_swap(void** ptr, void* old_value, void* new_value) {
+    return __sync_bool_compare_and_swap(ptr, old_value, new_value);
+  }
 
   /**
    * Atomically compare the memory location with the old value, and 
@@ -151,6 +155,7 @@ public:
   
 # ifdef __GNUC__
   static inline uint32_t leading_zeros(uint32_t x)    { return __builtin_clz(x);      }
+  static inline uint32_t trailing_zeros(uint32_t x)   { return __builtin_ctz(x);      }
   static inline uint32_t population_count(uint32_t x) { return __builtin_popcount(x); }
 # else
   # warning check whether your compiler provides the following functions as intrinsics 
@@ -160,6 +165,12 @@ public:
     return 32;
   }
   
+  uint32_t trailing_zeros(uint32_t x) {
+    for (int i = 0;  i < 32;  ++i)
+      if ( x  &  (1 << i))  return i;
+    return 32;
+  }
+  
   uint32_t population_count(uint32_t x)  {
     int sum = 0;
     for (int i = 0;  i < 32;  ++i)
@@ -176,14 +187,14 @@ public:
   static inline void  mem_fence() { __sync_synchronize(); /*This is a GCC build-in might need to be replaced */ }
   
 private:
-  static inline void* memalign(int align, int sz) { return (void*) ( (int(malloc(sz + align)) + align - 1) & ~(align-1) ); }
+  static inline void* memalign(int align, int sz) { return (void*) ( (intptr_t(malloc(sz + align)) + align - 1) & ~intptr_t(align-1) ); }
 public:
   static inline void* rvm_memalign(int al, int sz) {
     return memalign(al, sz);
   }
   
   static inline void* rvm_memalign_shared(OS_Heap, int align, int sz) {
-    return (void*) ( (int(rvm_malloc_shared(sz + align)) + align - 1) & ~(align-1) );
+    return (void*) ( (intptr_t(rvm_malloc_shared(sz + align)) + align - 1) & ~intptr_t(align-1) );
   }
   
   static inline void* malloc_uncacheable_shared(int alignment, int size) {
@@ -199,15 +210,17 @@ public:
   static void start_threads  (void (* /* helper_core_main */)(), char* /* argv */[]);
   static void start_processes(void (* /* helper_core_main */)(), char* /* argv */[]) { fatal(); }
   
-  static inline int get_thread_rank()  { return (int)pthread_getspecific(rank_key); }
+  static inline int get_thread_rank()  { return (int)(intptr_t)pthread_getspecific(rank_key); }
   
   static int abort_if_error(const char*, int); 
   
   static inline void yield_or_spin_a_bit() { assert_always(/*Memory_Semantics::is_using_threads()*/ !On_Tilera); pthread_yield_np(); }
 
   static void pin_thread_to_core(int32_t rank);
+  static bool home_memory_to_core(void* start, size_t bytes, int32_t rank);
 
 private:
+  static int numa_node_of_cpu(int32_t cpu);
   static void* pthread_thread_main(void* param);
   static int32_t       last_rank;  // needs to be accessed atomically (__sync_fetch_and_add)
   static pthread_key_t rank_key;
@@ -93,6 +93,9 @@ public:
   static inline bool atomic_compare_and_swap(int* ptr, int old_value, int new_value) {
     return atomic_bool_compare_and_exchange(ptr, old_value, new_value);
   }
+  static inline bool atomic_compare_and_swap(void** ptr, void* old_value, void* new_value) { // pointers are 32 bits here
+    return atomic_compare_and_swap((int*)ptr, (int)old_value, (int)new_value);
+  }
   
   /**
    * Atomically compare the memory location with the old value, and 
@@ -106,6 +109,7 @@ public:
   
     
   static inline uint32_t leading_zeros(uint32_t x)    { return __insn_clz(x);  }
+  static inline uint32_t trailing_zeros(uint32_t x)   { return __insn_ctz(x);  }
   static inline uint32_t population_count(uint32_t x) { return __insn_pcnt(x); }
   
   // About tmc_cmem_init:
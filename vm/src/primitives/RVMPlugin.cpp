@@ -388,12 +388,12 @@ void* primitiveAllObjectsInHeap() {
       Multicore_Object_Heap* h = The_Memory_System()->heaps[rank][mutability];
       int n = 0;
       FOR_EACH_OBJECT_IN_HEAP(h, p)
-        if (!p->isFreeObject())
+        if (h->is_accessible(p))
           ++n;
       Object_p r = The_Squeak_Interpreter()->splObj(Special_Indices::ClassArray).as_object()->instantiateClass(n);
       int i = 0;
       FOR_EACH_OBJECT_IN_HEAP(h, p) {
-        if (p->isFreeObject())
+        if (!h->is_accessible(p))
           continue;
         if (i >= n)
           break;
@@ -478,7 +478,7 @@ static int primitivePrintObjectForVMDebugging() {
     return 0;
   }
   Oop x = The_Squeak_Interpreter()->stackTop();
-  stdout_printer->lprintf("primitivePrintObjectForVMDebugging: Oop 0x%x, Object* 0x%x, ", x.bits(),
+  stdout_printer->lprintf("primitivePrintObjectForVMDebugging: Oop 0x%x, Object* %p, ", x.bits(),
                             x.is_mem() ? x.as_untracked_object_ptr() : NULL
                           );
 
@@ -692,6 +692,40 @@ static int primitiveWriteSnapshot() {
   return 0;
 }
 
+// With a semaphore index, answers false at once and has a forked child write the image, signalling the semaphore when done;
+// the saved image resumes with true, as after primitiveSnapshot.
+// Without, answers whether the last background snapshot was written, or nil while one is being written.
+static int primitiveBackgroundSnapshot() {
+  switch (The_Squeak_Interpreter()->get_argumentCount()) {
+    case 0: {
+      Oop r = Memory_System::is_snapshotting_in_background()  ?  The_Squeak_Interpreter()->roots.nilObj
+            : Memory_System::did_last_background_snapshot_succeed()  ?  The_Squeak_Interpreter()->roots.trueObj
+            : The_Squeak_Interpreter()->roots.falseObj;
+      The_Squeak_Interpreter()->popThenPush(1, r);
+      return 0;
+    }
+    case 1:
+      break;
+
+    default:
+      The_Squeak_Interpreter()->primitiveFail();
+      return 0;
+  }
+  int semaphore_index = The_Squeak_Interpreter()->stackIntegerValue(0);
+  if (The_Squeak_Interpreter()->failed()
+  ||  semaphore_index < 0
+  ||  !Memory_System::can_snapshot_in_background()
+  ||  Memory_System::is_snapshotting_in_background()) {
+    The_Squeak_Interpreter()->primitiveFail();
+    return 0;
+  }
+  The_Squeak_Interpreter()->pop(1);
+  The_Squeak_Interpreter()->snapshot(false, semaphore_index);
+  if (The_Squeak_Interpreter()->failed())
+    The_Squeak_Interpreter()->push(Oop::from_int(semaphore_index)); // snapshot restored the receiver
+  return 0;
+}
+
 
 static int primitiveMicrosecondClock() {
   // return a microsecond clock
@@ -803,6 +837,7 @@ void* RVMPlugin_exports[][3] = {
   {(void*) "RVMPlugin", (void*)"primitiveSetExtraWordSelector", (void*)primitiveSetExtraWordSelector},
 
   {(void*) "RVMPlugin", (void*)"primitiveWriteSnapshot", (void*)primitiveWriteSnapshot},
+  {(void*) "RVMPlugin", (void*)"primitiveBackgroundSnapshot", (void*)primitiveBackgroundSnapshot},
 
   {(void*) "RVMPlugin", (void*)"primitiveEmergencySemaphore", (void*)primitiveEmergencySemaphore},
   {(void*) "RVMPlugin", (void*)"primitiveMicrosecondClock", (void*)primitiveMicrosecondClock},
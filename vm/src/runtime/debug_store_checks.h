@@ -45,7 +45,7 @@ class Debug_Store_Checks {
   
   static void debug_store_check(const Oop* addr, Oop contents) { debug_store_check((oop_int_t*)addr, contents.bits()); }
   
-  static void debug_store_check(const Object** addr, Object* contents) { debug_store_check((oop_int_t*)addr, (oop_int_t)contents); }
+  static void debug_store_check(const Object** addr, Object* contents) { debug_store_check((oop_int_t*)addr, (oop_int_t)(intptr_t)contents); }
   
   
   static void debug_multistore_check(const oop_int_t* addr, oop_int_t src, int n) {
@@ -30,7 +30,7 @@ ON_TILERA_OR_ELSE(int, void) assert_failure(const char* func, const char* file,
 
 ON_TILERA_OR_ELSE(int, void) assert_eq_failure(const char* func, const char* file, const int line, const char* pred, const char* msg, void* a, void* b) {
   static char buf[10000];   // threadsafe? does not really matter here anymore...
-  error_printer->printf("%s: file %s, line %d, function %s, predicate %s, pid %d, 0x%x != 0x%x",
+  error_printer->printf("%s: file %s, line %d, function %s, predicate %s, pid %d, %p != %p",
           msg, file, line, func, pred, getpid(), a, b);
   error_printer->printf("%s\n", buf);
   
@@ -39,7 +39,7 @@ ON_TILERA_OR_ELSE(int, void) assert_eq_failure(const char* func, const char* fil
 }
 
 ON_TILERA_OR_ELSE(int, void) assert_eq_failure(const char* func, const char* file, const int line, const char* pred, const char* msg, int a, int b) {
-  assert_eq_failure(func, file, line, pred, msg, (void*)a, (void*)b);
+  assert_eq_failure(func, file, line, pred, msg, (void*)intptr_t(a), (void*)intptr_t(b));
   ON_TILERA_OR_ELSE(return 0, );
 }
 
@@ -69,7 +69,7 @@ Oop Execution_Tracer::get() {
 
 
 void Execution_Tracer::copy_elements(int src_offset, void* dst, int dst_offset, int num_elems, Object_p dst_obj) {
-  lprintf( "copy_elements src_offset %d, buffer 0x%x, dst 0x%x, dst_offset %d, num_elems %d, dst_obj 0x%x, next %d\n",
+  lprintf( "copy_elements src_offset %d, buffer %p, dst %p, dst_offset %d, num_elems %d, dst_obj %p, next %d\n",
           src_offset, buffer, dst, dst_offset, num_elems, (Object*)dst_obj, next);
 
 
@@ -107,7 +107,7 @@ void Execution_Tracer::copy_elements(int src_offset, void* dst, int dst_offset,
         assert_always(dst_oop[e_pc  ].is_int());
         assert_always(dst_oop[e_rank].is_int());
         assert_always(dst_oop[e_is_block] == The_Squeak_Interpreter()->roots.trueObj  ||  dst_oop[e_is_block] == The_Squeak_Interpreter()->roots.falseObj);
-        assert_always( (int(dst_oop) - int(dst_obj) - Object::BaseHeaderSize) % e_N  == 0 );
+        assert_always( (int((char*)dst_oop - dst_obj->as_char_p()) - Object::BaseHeaderSize) % e_N  == 0 );
       }
         break;
       case k_gc:
@@ -174,7 +174,7 @@ void Execution_Tracer::print_entries(Oop ents, Printer* p) {
         default: fatal(); break;
         case k_proc: {
           Oop process      = eo->fetchPointer(i * e_N  +  e_process); assert(process.is_mem());
-          p->printf("switch to process 0x%x", process.as_untracked_object_ptr());
+          p->printf("switch to process %p", process.as_untracked_object_ptr());
         }
           break;
 
@@ -184,7 +184,7 @@ void Execution_Tracer::print_entries(Oop ents, Printer* p) {
         //int aux2         = eo->fetchPointer(i * e_N  +  e_aux2).integerValue();
         int id           = eo->fetchPointer(i * e_N  +  e_id  ).integerValue();
         // p->printf("on %d: aux1 0x%x aux2 0x%x id %d", rank, aux1, aux2, id);
-        p->printf("on %d: aux1 %s id %d", rank, aux1, id);
+        p->printf("on %d: aux1 %d id %d", rank, aux1, id);
       }
         break;
 
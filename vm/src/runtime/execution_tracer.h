@@ -79,7 +79,7 @@ public:
     e->kind = k_aux;
     e->id = id;
     e->rank = Logical_Core::my_rank();
-    e->aux1 = (int)why;
+    e->aux1 = (int)(intptr_t)why;
     e->aux2 = 0;
     /*
     if (ctx.is_mem()) {
@@ -119,7 +119,7 @@ public:
     e->bcCount = bc_count;
 
     if (ctx.is_mem()) {
-      e->aux1 = (int)ctx.as_object();
+      e->aux1 = (int)(intptr_t)ctx.as_object();
       e->aux2 = ctx.as_object()->fetchPointer(Object_Indices::InstructionPointerIndex).integerValue();
     }
   }
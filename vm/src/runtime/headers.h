@@ -33,6 +33,7 @@
 # include <sys/mman.h>
 # include <fcntl.h>
 # include <unistd.h>
+# include <sys/wait.h>
 # include <signal.h>
 # include <errno.h>
 
@@ -60,6 +61,10 @@
 #  include "buffered_channel_debug.h"
 # endif
 
+# if __SSSE3__
+#  include <immintrin.h>
+# endif
+
 # if On_iOS
 #  include <libkern/OSAtomic.h>
 # elif On_Apple
@@ -174,6 +179,7 @@
 # include "scheduler_mutex.h"
 # include "semaphore_mutex.h"
 
+# include "free_chunk_lists.h"
 # include "abstract_object_heap.h"
 # include "multicore_object_heap.h"
 
@@ -215,6 +221,10 @@
 
 
 # include "gc_oop_stack.h"
+# include "parallel_mark_work_pool.h"
+# include "parallel_heap_scan.h"
+# include "snapshot_output.h"
+# include "nursery.h"
 # include "abstract_mark_sweep_collector.h"
 # include "indirect_oop_mark_sweep_collector.h"
 # include "mark_sweep_collector.h"
@@ -105,18 +105,31 @@ template("-display",            displayName=STRING,
 template("-geom",               set_geom(STRING),                                 "<digit,digit>") \
 template("-num_cores",          set_num_cores(STRING),                            "<digit{1,2}>") \
 template("-min_heap_MB",        Memory_System::min_heap_MB = NUMBER,              "N") \
+template("-max_heap_MB",        Memory_System::max_heap_MB = NUMBER,              "N") \
 template("-profile_after",      The_Squeak_Interpreter()->set_profile_after(NUMBER), "N") \
 template("-quit_after",         The_Squeak_Interpreter()->set_quit_after(NUMBER),    "N") \
 template("-round_robin_period", Memory_System::set_round_robin_period(NUMBER),    "N") \
 template("-run_mask",           The_Squeak_Interpreter()->set_run_mask(NUMBER64),    "N") \
 template("-trace",              set_trace_file(STRING),                           "file-name") \
-template("-num_chips",          The_Squeak_Interpreter()->set_num_chips(NUMBER),    "N")
+template("-num_chips",          The_Squeak_Interpreter()->set_num_chips(NUMBER),    "N") \
+template("-concurrent_mark_start_percent", Abstract_Mark_Sweep_Collector::concurrent_mark_start_percent = NUMBER, "N") \
+template("-concurrent_mark_step_size",     Abstract_Mark_Sweep_Collector::concurrent_mark_step_size = NUMBER,     "N") \
+template("-incremental_gc_start_percent",  Abstract_Mark_Sweep_Collector::incremental_gc_start_percent = NUMBER,  "N") \
+template("-incremental_gc_step_size",      Abstract_Mark_Sweep_Collector::incremental_gc_step_size = NUMBER,      "N") \
+template("-nursery_KB",         Memory_System::nursery_KB = NUMBER,               "N") \
+template("-lazy_sweep_step_KB", Memory_System::lazy_sweep_step_KB = NUMBER,       "N") \
+template("-compaction_threshold_percent", Memory_System::compaction_threshold_percent = NUMBER, "N") \
+template("-object_table_compaction_percent", Memory_System::object_table_compaction_percent = NUMBER, "N") \
+template("-large_object_KB",    Memory_System::set_large_object_KB(NUMBER),       "N") \
+template("-tlab_KB",            Memory_System::tlab_KB = NUMBER,                  "N") \
+template("-borrow_until_percent_free", Memory_System::borrow_until_percent_free = NUMBER, "N")
 
 
 
 # define FOR_ALL_BOOLEAN_ARGS_DO(template) \
 template("-dont_replicate_all",    Memory_System::replicate_all = false, "not replicating everything") \
 template("-eschew_huge_pages",  Memory_System::use_huge_pages = false, "not using huge pages") \
+template("-transparent_huge_pages", Memory_System::use_transparent_huge_pages = true, "using transparent huge pages") \
 template("-headless",           headless = 1, "headless") \
 template("-make_checkpoint",    The_Squeak_Interpreter()->set_make_checkpoint(true), "making checkpoint") \
 template("-no_fence",           The_Squeak_Interpreter()->set_fence(false), "not fencing memory on control transfers") \
@@ -125,6 +138,16 @@ template("-replicate_methods",  Memory_System::replicate_methods = true, "replic
 template("-use_checkpoint",     The_Squeak_Interpreter()->set_use_checkpoint(true), "using checkpoint") \
 template("-replicate_OT",       Multicore_Object_Table::replicate = true, "let hardware replicate the object table") \
 template("-print_gc",           Abstract_Mark_Sweep_Collector::print_gc = true, "Print GC") \
+template("-serial_mark",        Abstract_Mark_Sweep_Collector::parallel_mark = false, "marking on one core only") \
+template("-serial_heap_scans",  Memory_System::parallel_heap_scans = false, "walking all heaps for become and the like on one core only") \
+template("-background_snapshots", Memory_System::background_snapshots = true, "mapping heaps privately so snapshots can be written by a forked child") \
+template("-concurrent_mark",    Abstract_Mark_Sweep_Collector::concurrent_mark = true, "marking concurrently with the mutator") \
+template("-mark_bitmap",        Memory_System::use_mark_bitmap = true, "marking in a side bitmap instead of in object headers") \
+template("-lazy_sweep",         Memory_System::lazy_sweep = Memory_System::use_mark_bitmap = true, "sweeping lazily after the pause, with a mark bitmap") \
+template("-incremental_gc",     Abstract_Mark_Sweep_Collector::incremental_gc = Memory_System::lazy_sweep = Memory_System::use_mark_bitmap = Memory_System::use_free_lists = true, "collecting incrementally when the image asks, sweeping lazily onto free lists") \
+template("-free_lists",         Memory_System::use_free_lists = true, "sweeping in place onto free lists, compacting only fragmented heaps") \
+template("-numa",               Memory_System::home_to_numa_nodes = true, "placing each core's heaps and object table segments on its NUMA node") \
+template("-borrow_space",       Memory_System::borrow_space = true, "borrowing space from other cores' heaps before collecting") \
 template("-version",            print_version_info(), "Print full version information") \
 template("-use_cpu_ms",         The_Squeak_Interpreter()->set_use_cpu_ms(true), "use CPU time instead of elapsed time")
 
@@ -271,6 +294,10 @@ void initialize_basic_subsystems() {
 }
 
 void read_image(char* image_path) {
+  // checkpoints hold object table addresses, which move from run to run with Compressed_Oops
+  if (Compressed_Oops  &&  (The_Squeak_Interpreter()->make_checkpoint() || The_Squeak_Interpreter()->use_checkpoint()))
+    fatal("-make_checkpoint and -use_checkpoint are not supported with Compressed_Oops");
+
   if (The_Squeak_Interpreter()->use_checkpoint())
     Squeak_Image_Reader::fake_read(image_path, The_Memory_System(), The_Squeak_Interpreter());
   else
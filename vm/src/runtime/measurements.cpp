@@ -49,7 +49,7 @@ Measurements::Measurements() {
 void Measurements::print() {
   if (!Measure)
     return;
-  fprintf(stdout, "\n\nMeasurements (baseline = %ld):\n", baseline);
+  fprintf(stdout, "\n\nMeasurements (baseline = %d):\n", baseline);
 
   print_details();
   print_summaries();
@@ -57,7 +57,7 @@ void Measurements::print() {
 
 void Measurements::print_summaries() {
   print_config_for_spreadsheet();
-  fprintf(stdout, "\n\nMeasurements summary (baseline = %ld):\n", baseline);
+  fprintf(stdout, "\n\nMeasurements summary (baseline = %d):\n", baseline);
 
    fprintf(stdout, "description\tmean\tmode\tmin\t10%%\t25%%\tmedian\t75%%\t90%%\tmax\tinliers\toutliers\t< baseline\n");
    fprintf(stdout, "description\tmean\tmode\tmin\t10%%\t25%%\tmedian\t75%%\t90%%\tmax\tinliers\toutliers\t< baseline\n");
@@ -71,7 +71,7 @@ void Measurements::print_summaries() {
 
 void Measurements::print_details() {
   print_config_for_spreadsheet();
-  fprintf(stdout, "\n\nMeasurements details (baseline = %ld):\n", baseline);
+  fprintf(stdout, "\n\nMeasurements details (baseline = %d):\n", baseline);
 
   for (int i = 0;  i < N;  ++i)
     if (measurements[i].total_inliers())
@@ -79,17 +79,17 @@ void Measurements::print_details() {
 
   FOR_ALL_BUCKETS(b) {
     if (b < baseline) continue;
-    fprintf(stdout, "\n%ld", b - baseline);
+    fprintf(stdout, "\n%d", b - baseline);
     for (int i = 0;  i < N;  ++i)
       if (measurements[i].total_inliers())
-        fprintf(stdout, "\t%ld%%", measurements[i].percentage_in_bucket(b));
+        fprintf(stdout, "\t%d%%", measurements[i].percentage_in_bucket(b));
   }
   fprintf(stdout, "\n\n");
 }
 
 
  void Measurements::Measurement::print_summary(const char* lbl, int32 baseline) {
-  fprintf(stdout, "%s" "\t%.1f" "\t%ld" "\t%ld" "\t%ld" "\t%ld" "\t%ld" "\t%ld" "\t%ld" "\t%ld" "\t%lld" "\t%ld" "\t%ld",
+  fprintf(stdout, "%s" "\t%.1f" "\t%d" "\t%d" "\t%d" "\t%d" "\t%d" "\t%d" "\t%d" "\t%d" "\t%lld" "\t%d" "\t%d",
     lbl,
     mean_inliers(baseline),
     mode_inliers(baseline),
@@ -15,7 +15,7 @@
   # define PERF_CNT(interp, counter_or_accumulator_call) interp->perf_counter.counter_or_accumulator_call
   
 # else
-  # define PERF_CNT(interp, counter_or_accumulator_call)
+  # define PERF_CNT(interp, counter_or_accumulator_call) ((void)0)
 
 # endif  // Collect_Performance_Counters
 
@@ -19,8 +19,8 @@ class Printer {
   Printer(bool iid = false) { include_implementation_details = iid; }
   virtual ~Printer() {}
   bool include_implementation_details;
-  void printf(const char* fmt, ...);
-  void lprintf(const char* fmt, ...);
+  void printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  void lprintf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
   void nl() { printf("\n"); }
   virtual void dittoing_off() {}
   virtual void dittoing_on() {}
@@ -16,6 +16,7 @@ class Runtime_Tester {
  public:
   static void test() {
     Bitmap::test();
+    Atomic_Bitmap::test();
     Bytemap::test();
     typedefs::check_typedefs();
     Object::test();
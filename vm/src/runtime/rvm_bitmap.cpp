@@ -25,3 +25,52 @@ void Bitmap::test() {
     assert_always(b.is_set_bool(i) != (i % 7  ==  0));
 }
 
+
+void* Atomic_Bitmap::operator new(size_t s) { return Memory_Semantics::shared_malloc(s); }
+
+Atomic_Bitmap::Atomic_Bitmap(size_t bit_length) {
+  _bit_length = bit_length;
+  _map = (map_t*)Memory_Semantics::shared_calloc(map_length(bit_length), sizeof(map_t));
+  if (_map == NULL)  fatal("Atomic_Bitmap allocation");
+}
+
+
+void Atomic_Bitmap::clear_range(size_t from, size_t to) {
+  if (from >= to)  return;
+  size_t first = map_index(from),  last = map_index(to - 1);
+  map_t first_mask = ~(mask_for(from) - 1);
+  map_t last_mask  = (mask_for(to - 1) << 1) - 1; // wraps to all ones for the top bit
+  if (first == last) {
+    _map[first] &= ~(first_mask & last_mask);
+    return;
+  }
+  _map[first] &= ~first_mask;
+  if (last - first > 1)
+    bzero(&_map[first + 1], (last - first - 1) * sizeof(map_t));
+  _map[last] &= ~last_mask;
+}
+
+
+void Atomic_Bitmap::test() {
+  Atomic_Bitmap b(200);
+  assert_always(b.find_next_set(0, 200) == 200);
+  for (int i = 3;  i < 200;  i += 37)  assert_always(b.set(i));
+  assert_always(!b.set(3));
+  for (int i = 0;  i < 200;  ++i)
+    assert_always(b.is_set(i) == (i % 37  ==  3));
+  assert_always(b.find_next_set(0,   200) ==   3);
+  assert_always(b.find_next_set(4,   200) ==  40);
+  assert_always(b.find_next_set(41,  100) ==  77);
+  assert_always(b.find_next_set(78,  100) == 100);
+  assert_always(b.find_next_set(186, 200) == 188);
+  assert_always(b.find_next_set(189, 200) == 200);
+  b.clear(40);
+  assert_always(b.find_next_set(4,   200) ==  77);
+  b.clear_range(70, 160);
+  assert_always(b.find_next_set(4,   200) == 188);
+  assert_always(b.is_set(3));
+  for (int i = 0;  i < 200;  ++i)  b.set(i);
+  b.clear_range(31, 65);
+  for (int i = 0;  i < 200;  ++i)
+    assert_always(b.is_set(i) == (i < 31  ||  i >= 65));
+}
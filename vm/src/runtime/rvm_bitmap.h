@@ -76,7 +76,7 @@ public:
   // mutating
 
   void set(int i, bool b) { b ? set(i) : clear(i); }
-  void clear(int i) { element_for(i) &= ~mask_for(i); }
+  void clear(size_t i) { element_for(i) &= ~mask_for(i); }
   void set  (int i) { element_for(i) |=  mask_for(i); }
 
   void clear_all() { memset(_map, 0, _map_length * map_elem_byte_size); }
@@ -89,3 +89,61 @@ public:
   static void test();
 };
 
+
+
+// A fixed-size bitmap in shared memory, for marking from several cores at once:
+// bits are set and cleared atomically, and can be searched a word at a time.
+// Indices are size_t, as a bit per word of a heap of more than a few gigabytes is more than an int can count.
+class Atomic_Bitmap {
+  typedef u_int32 map_t;  static const int map_elem_shift = 5;
+  static const int map_elem_bit_size = sizeof(map_t) * 8;
+
+  size_t _bit_length;
+  map_t* _map;
+
+  static map_t mask_for(size_t bit_index) { return map_t(1) << (bit_index & (map_elem_bit_size - 1)); }
+  static size_t map_index(size_t bit_index) { return bit_index >> map_elem_shift; }
+  static size_t map_length(size_t bit_length) { return map_index(bit_length + map_elem_bit_size - 1); }
+
+public:
+  void* operator new(size_t);
+  Atomic_Bitmap(size_t bit_length);
+
+  size_t bit_length() { return _bit_length; }
+
+  bool is_set(size_t i) { return _map[map_index(i)] & mask_for(i); }
+
+  // returns false if the bit was already set
+  bool set(size_t i) {
+    int* w = (int*)&_map[map_index(i)];  map_t m = mask_for(i);
+    for (;;) {
+      map_t old = *w;
+      if (old & m)  return false;
+      if (OS_Interface::atomic_compare_and_swap(w, old, old | m))  return true;
+    }
+  }
+  void clear(size_t i) {
+    int* w = (int*)&_map[map_index(i)];  map_t m = mask_for(i);
+    for (;;) {
+      map_t old = *w;
+      if (!(old & m)  ||  OS_Interface::atomic_compare_and_swap(w, old, old & ~m))  return;
+    }
+  }
+
+  // Not atomic, only for when nobody else is setting bits in the range.
+  void clear_range(size_t from, size_t to);
+
+  // returns to if there is no set bit in [from, to)
+  size_t find_next_set(size_t from, size_t to) {
+    if (from >= to)  return to;
+    size_t wi = map_index(from);
+    map_t w = _map[wi]  &  ~(mask_for(from) - 1);
+    for (size_t last = map_index(to - 1);  w == 0;  w = _map[wi])
+      if (++wi > last)
+        return to;
+    size_t i = (wi << map_elem_shift) + OS_Interface::trailing_zeros(w);
+    return i < to  ?  i  :  to;
+  }
+
+  static void test();
+};
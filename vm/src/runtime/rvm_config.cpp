@@ -25,9 +25,12 @@ void print_config() {
 
 
 
+static void print_flag_for_spreadsheet(const char* name, int value)         { fprintf(stdout, "%s\t%d\n", name, value); }
+static void print_flag_for_spreadsheet(const char* name, const char* value) { fprintf(stdout, "%s\t%s\n", name, value == NULL ? "0" : value); }
+
 void print_config_for_spreadsheet() {
 
-  # define PRINT( name) fprintf(stdout, "%s\t%d\n", #name, name);
+  # define PRINT( name) print_flag_for_spreadsheet(#name, name);
 
   DO_ALL_CONFIG_FLAGS(PRINT)
   fprintf(stdout, "\n");
@@ -91,6 +91,8 @@
   template(Track_OnStackPointer) \
   template(Omit_Duplicated_OT_Overhead) \
   template(Omit_Spare_Bit) \
+  template(Compressed_Oops) /* 64-bit build, oops are 32-bit object table indices */ \
+  template(Omit_Object_Table) /* oops are object addresses, moving an object means fixing up the references */ \
   template(Trace_Execution) \
   template(Trace_GC_For_Debugging) \
   template(Track_Last_BC_For_Debugging) \
@@ -150,7 +152,11 @@
   # define On_Tilera (!On_Apple && !On_Intel_Linux)
 # endif
 
-# define On_Tilera_With_GCC (On_Tilera && !defined(__TILECC__))
+# ifdef __TILECC__
+#  define On_Tilera_With_GCC 0
+# else
+#  define On_Tilera_With_GCC On_Tilera
+# endif
 
 
 # ifndef Enforce_Threads
@@ -260,7 +266,7 @@
 # endif
 
 # ifndef StopOnSend
-#  define StopOnSend ((const char *const)0)
+#  define StopOnSend ((const char *)0)
 # endif
 
 # ifndef NthSendForStopping
@@ -279,6 +285,28 @@
 #  define Omit_Spare_Bit 1
 # endif
 
+// On 64-bit hosts, oops remain 32 bits wide and index the object table,
+// whose entries hold full Object pointers. The object table lives in one
+// reserved range, which is only shared between threads.
+# ifndef Compressed_Oops
+#  define Compressed_Oops 0
+# endif
+
+# if Compressed_Oops && Using_Processes
+#  error Compressed_Oops requires Enforce_Threads
+# endif
+
+// Without the object table, as_object is free but compaction, become and
+// moves between heaps have to scan for the references, see Forwarding_Closure.
+// Meant for workloads that rarely move objects; nurseries are not supported.
+# ifndef Omit_Object_Table
+#  define Omit_Object_Table 0
+# endif
+
+# if Omit_Object_Table && Compressed_Oops
+#  error Compressed_Oops needs the object table
+# endif
+
 # ifndef Checksum_Messages
 #  define Checksum_Messages 0
 # endif
@@ -125,7 +125,7 @@ class Safepoint_Master_Control {
 
 public:
   static const bool verbose = false;
-  void smc_printf(const char*, ...);
+  void smc_printf(const char*, ...) __attribute__((format(printf, 2, 3)));
   void smc_vprintf(const char*, va_list);
   static void smc_white_space();
 
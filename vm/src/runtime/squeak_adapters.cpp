@@ -451,8 +451,8 @@ sqInt oopForPointer(char *ptr)			  { return (sqInt) ((Object*)ptr)->as_oop().bit
 // squeak code used to use pointerForOop for these
 char* pointerForIndex_xxx_dmu(sqInt index)  {
   if (check_assertions && index)
-    assert( ((Object*)index)->my_heap_contains_me());
-  return (char*)index;
+    assert( ((Object*)uintptr_t(u_int32(index)))->my_heap_contains_me());
+  return (char*)uintptr_t(u_int32(index)); // the heap lies below 2GB, see heap_address_hint
 }
 
 
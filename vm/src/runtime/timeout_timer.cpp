@@ -35,11 +35,11 @@ void Timeout_Timer::restart() {
 
 void Timeout_Timer::complain() {
   if (strcmp(why, Message_Statics::message_names[Message_Statics::runPrimitiveResponse]) == 0 )
-    lprintf("timed out waiting for %s from %d after %d secs, remote_prim_fn: 0x%x\n",
+    lprintf("timed out waiting for %s from %d after %llu secs, remote_prim_fn: %p\n",
             why, who_I_am_waiting_for, elapsed_seconds(), Message_Statics::remote_prim_fn);
 
   else
-    lprintf("timed out waiting for %s from %d after %d secs\n",
+    lprintf("timed out waiting for %s from %d after %llu secs\n",
             why, who_I_am_waiting_for, elapsed_seconds());
 }
 
@@ -62,7 +62,7 @@ void Timeout_Timer::restart_all() {
 }
 
 void Safepoint_Acquisition_Timer::complain() {
-  lprintf( "too long to get safepoint: %ld s\n", elapsed_seconds());
+  lprintf( "too long to get safepoint: %llu s\n", elapsed_seconds());
 }
 
 void Safepoint_Acquisition_Timer::act() {
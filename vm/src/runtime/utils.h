@@ -23,6 +23,9 @@ inline int divide_by_power_of_two_and_round_up(int x, int power_of_two) {
 inline int divide_and_round_up(int x, int y) {
   return (x + y - 1) / y;
 }
+inline size_t divide_and_round_up(size_t x, size_t y) {
+  return (x + y - 1) / y;
+}
 inline int round_up(int x, int y) {
   return divide_and_round_up(x, y) * y;
 }
@@ -34,13 +37,23 @@ inline int round_up(int x, int y) {
 inline void swap_bytes_long(int32* p) {
   *p = (*p << 24)  |  ((*p << 8) & 0xff0000)  |  ((*p >> 8) & 0xff00)  |  ((*p >> 24) & 0xff);
 }
+// Called for every byte object of a cross-endian image, so it must not print.
+// With -march=native, the shuffles swap 8 or 4 words at a time.
 inline void reverseBytes(int32* start, int32* stop) {
-  fprintf(stdout, "reversing bytes\n");
-
-  for (int32* p = start;  p < stop;  ++p)
+  int32* p = start;
+# if __AVX2__
+  const __m256i swap_words_256 = _mm256_setr_epi8(3, 2, 1, 0,  7, 6, 5, 4,  11, 10, 9, 8,  15, 14, 13, 12,
+                                                  3, 2, 1, 0,  7, 6, 5, 4,  11, 10, 9, 8,  15, 14, 13, 12);
+  for (;  stop - p >= 8;  p += 8)
+    _mm256_storeu_si256((__m256i*)p, _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i*)p), swap_words_256));
+# endif
+# if __SSSE3__
+  const __m128i swap_words_128 = _mm_setr_epi8(3, 2, 1, 0,  7, 6, 5, 4,  11, 10, 9, 8,  15, 14, 13, 12);
+  for (;  stop - p >= 4;  p += 4)
+    _mm_storeu_si128((__m128i*)p, _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)p), swap_words_128));
+# endif
+  for (;  p < stop;  ++p)
     swap_bytes_long(p);
-
-  fprintf(stdout, "done reversing bytes\n");
 }
 
 
@@ -86,6 +99,6 @@ int least_significant_bit_position(u_int64);
 void print_time();
 
 
-extern "C" void lprintf(const char* msg, ...);
+extern "C" void lprintf(const char* msg, ...) __attribute__((format(printf, 1, 2)));
 void vlprintf(const char* msg, va_list ap);
 
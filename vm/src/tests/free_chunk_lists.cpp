@@ -0,0 +1,127 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+# include <gtest/gtest.h>
+
+# include "headers.h"
+# include "test_memory_system.h"
+
+
+/* Carves chunks out of one block of the heap, and frees the whole block again at the end,
+   so the heap stays walkable for the other tests. */
+class FreeChunkListsTest : public ::testing::Test {
+protected:
+  static const oop_int_t block_bytes = 64 * 1024;
+  Abstract_Object_Heap* heap;
+  Chunk* block;
+  char* next;
+  Free_Chunk_Lists lists;
+
+  virtual void SetUp() {
+    Test_Memory_System::initialize();
+    heap = The_Memory_System()->heaps[Logical_Core::my_rank()][Memory_System::read_write];
+    block = heap->allocateChunk(block_bytes);
+    next = (char*)block;
+  }
+  virtual void TearDown() {
+    block->make_free_object(block_bytes, 0);
+  }
+
+  Chunk* free_words(int words) {
+    Chunk* c = (Chunk*)next;
+    next += words * sizeof(Oop);
+    lists.free_chunk(c, words * sizeof(Oop));
+    return c;
+  }
+  // keeps neighbours from being taken for the rest of a chunk
+  void skip_words(int words) { next += words * sizeof(Oop); }
+};
+
+
+TEST_F(FreeChunkListsTest, ExactSizeIsTakenFirst) {
+  Chunk* c8 = free_words(8);  skip_words(2);
+  Chunk* c6 = free_words(6);  skip_words(2);
+  ASSERT_EQ(oop_int_t(14 * sizeof(Oop)), oop_int_t(lists.bytes()));
+
+  ASSERT_EQ(c6, lists.take(6 * sizeof(Oop)));
+  ASSERT_EQ(c8, lists.take(8 * sizeof(Oop)));
+  ASSERT_EQ(0u, lists.bytes());
+  ASSERT_EQ((Chunk*)NULL, lists.take(6 * sizeof(Oop)));
+}
+
+
+TEST_F(FreeChunkListsTest, RestOfABiggerChunkGoesBack) {
+  Chunk* c = free_words(40);
+  ASSERT_EQ(c, lists.take(10 * sizeof(Oop)));
+
+  // the rest is still a free object, and listed in its own size class
+  Chunk* rest = (Chunk*)((char*)c + 10 * sizeof(Oop));
+  ASSERT_TRUE(rest->object_from_chunk()->isFreeObject());
+  ASSERT_EQ(oop_int_t(30 * sizeof(Oop)), oop_int_t(lists.bytes()));
+  ASSERT_EQ(rest, lists.take(30 * sizeof(Oop)));
+}
+
+
+TEST_F(FreeChunkListsTest, ChunksTooSmallForALinkStayInTheHeap) {
+  oop_int_t words = Free_Chunk_Lists::min_free_bytes / sizeof(Oop);
+  ASSERT_LT(oop_int_t(words * sizeof(Oop)), Free_Chunk_Lists::min_listed_bytes);
+
+  Chunk* c = free_words(words);
+  ASSERT_TRUE(c->object_from_chunk()->isFreeObject());
+  ASSERT_EQ(0u, lists.bytes());
+  ASSERT_FALSE(lists.has_chunk_for(words * sizeof(Oop)));
+}
+
+
+/* A chunk must match exactly or leave room for a free object; one in between will not do. */
+TEST_F(FreeChunkListsTest, NoSliverIsLeft) {
+  oop_int_t sliver = Free_Chunk_Lists::min_free_bytes - sizeof(Oop);
+  free_words(20);
+  ASSERT_FALSE(lists.has_chunk_for(20 * sizeof(Oop) - sliver));
+  ASSERT_TRUE (lists.has_chunk_for(20 * sizeof(Oop) - Free_Chunk_Lists::min_free_bytes));
+  ASSERT_TRUE (lists.has_chunk_for(20 * sizeof(Oop)));
+}
+
+
+/* Chunks of 64 words and up share a list per power of two, which is searched first-fit. */
+TEST_F(FreeChunkListsTest, FirstFitWithinAPowerOfTwoClass) {
+  Chunk* c100 = free_words(100);  skip_words(2);
+  Chunk* c120 = free_words(120);  skip_words(2);
+  Chunk* c110 = free_words(110);  skip_words(2);
+
+  // the list is last in, first out: 110, 120, 100
+  ASSERT_EQ(c120, lists.take(115 * sizeof(Oop)));
+  ASSERT_EQ(c110, lists.take(105 * sizeof(Oop)));
+  ASSERT_EQ(c100, lists.take(100 * sizeof(Oop)));
+}
+
+
+TEST_F(FreeChunkListsTest, SmallRequestFallsThroughToABiggerClass) {
+  Chunk* c = free_words(300);
+  ASSERT_EQ(c, lists.take(5 * sizeof(Oop)));
+  ASSERT_EQ(oop_int_t(295 * sizeof(Oop)), oop_int_t(lists.bytes()));
+  ASSERT_TRUE(lists.verify(heap));
+}
+
+
+TEST_F(FreeChunkListsTest, Verify) {
+  for (int words = 5;  words < 200;  words += 7) {
+    free_words(words);
+    skip_words(2);
+  }
+  ASSERT_TRUE(lists.verify(heap));
+  lists.take(50 * sizeof(Oop));
+  lists.take(7 * sizeof(Oop));
+  ASSERT_TRUE(lists.verify(heap));
+}
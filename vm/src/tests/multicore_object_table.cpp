@@ -0,0 +1,246 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+# include <gtest/gtest.h>
+
+# include <vector>
+
+# include "headers.h"
+# include "test_memory_system.h"
+
+# if !Omit_Object_Table
+
+/* Entries are handed out for one object over and over, since only the table is looked at,
+   and all of them are freed again at the end. */
+class MulticoreObjectTableTest : public ::testing::Test {
+protected:
+  Multicore_Object_Table* ot;
+  Object_p obj;
+  std::vector<Oop> oops;
+  int rank;
+  int group_size;
+
+  virtual void SetUp() {
+    Test_Memory_System::initialize();
+    ot = The_Memory_System()->object_table;
+    obj = Test_Memory_System::new_old_array(1);
+    rank = Logical_Core::my_rank();
+    group_size = Logical_Core::group_size;
+  }
+  virtual void TearDown() {
+    free_oops(oops.size());
+    Logical_Core::group_size = group_size;
+  }
+
+  void allocate_oops(u_int32 n) {
+    for (u_int32 i = 0;  i < n;  ++i)
+      oops.push_back(ot->allocate_oop_and_set_backpointer(obj, rank  COMMA_TRUE_OR_NOTHING));
+  }
+  void free_oops(u_int32 n) {
+    for (u_int32 i = 0;  i < n;  ++i) {
+      ot->free_oop(oops.back()  COMMA_TRUE_OR_NOTHING);
+      oops.pop_back();
+    }
+  }
+  // uses up the free entries of my rank, so the next allocation has to find more
+  void drain_free_entries() { allocate_oops(ot->free_entries(rank)); }
+
+  // Fills a few segments, then frees all but one entry in every hundred, each of those for an object of its own.
+  std::vector<Object_p> leave_sparse_segments() {
+    std::vector<Object_p> survivors;
+    for (int i = 0;  i < 8 * Multicore_Object_Table::entries_per_segment();  ++i)
+      if (i % 100 == 0)
+        survivors.push_back(Test_Memory_System::new_old_array(1));
+      else
+        allocate_oops(1);
+    free_oops(oops.size());
+    return survivors;
+  }
+  void free_survivors(std::vector<Object_p>& survivors) {
+    for (size_t i = 0;  i < survivors.size();  ++i)
+      ot->free_oop(survivors[i]->as_oop()  COMMA_TRUE_OR_NOTHING);
+  }
+};
+
+
+TEST_F(MulticoreObjectTableTest, SurplusGoesToTheSpares) {
+  const u_int32 keep = Multicore_Object_Table::free_entries_to_keep();
+  allocate_oops(3 * keep);
+  free_oops(3 * keep);
+  u_int32 free_before = ot->free_entries(rank);
+  u_int32 spare_before = ot->spare_entries();
+  ASSERT_GT(free_before, keep);
+
+  ot->rebalance_free_entries();
+
+  ASSERT_EQ(keep, ot->free_entries(rank));
+  ASSERT_EQ(spare_before + free_before - keep, ot->spare_entries());
+  ASSERT_TRUE(ot->verify());
+}
+
+
+TEST_F(MulticoreObjectTableTest, KeepsWhatItNeeds) {
+  ot->rebalance_free_entries();
+  drain_free_entries();
+  const u_int32 keep = Multicore_Object_Table::free_entries_to_keep();
+  allocate_oops(keep);
+  free_oops(keep);
+  u_int32 spare_before = ot->spare_entries();
+
+  ot->rebalance_free_entries();
+
+  ASSERT_EQ(keep, ot->free_entries(rank));
+  ASSERT_EQ(spare_before, ot->spare_entries());
+}
+
+
+TEST_F(MulticoreObjectTableTest, RunningOutTakesABatchOfSpares) {
+  const u_int32 batch = Multicore_Object_Table::free_entries_per_batch();
+  allocate_oops(3 * batch);
+  free_oops(3 * batch);
+  ot->rebalance_free_entries();
+  u_int32 spare_before = ot->spare_entries();
+  u_int32 entries_before = ot->entries(rank);
+  ASSERT_GE(spare_before, batch);
+
+  drain_free_entries();
+  allocate_oops(1);
+
+  ASSERT_EQ(entries_before, ot->entries(rank)); // no new segment
+  ASSERT_EQ(spare_before - batch, ot->spare_entries());
+  ASSERT_EQ(batch - 1, ot->free_entries(rank));
+  ASSERT_TRUE(ot->verify());
+}
+
+
+TEST_F(MulticoreObjectTableTest, RebalanceTopsUpAShortList) {
+  const u_int32 batch = Multicore_Object_Table::free_entries_per_batch();
+  allocate_oops(3 * batch);
+  free_oops(3 * batch);
+  ot->rebalance_free_entries();
+  drain_free_entries();
+  free_oops(batch / 2);
+  u_int32 spare_before = ot->spare_entries();
+  ASSERT_GE(spare_before, batch);
+
+  ot->rebalance_free_entries();
+
+  ASSERT_EQ(batch / 2 + batch, ot->free_entries(rank));
+  ASSERT_EQ(spare_before - batch, ot->spare_entries());
+}
+
+
+TEST_F(MulticoreObjectTableTest, WithoutSparesANewSegmentIsMade) {
+  // the spares run out first
+  while (ot->spare_entries() > 0) {
+    drain_free_entries();
+    allocate_oops(1);
+  }
+  drain_free_entries();
+  u_int32 entries_before = ot->entries(rank);
+
+  allocate_oops(1);
+
+  ASSERT_GT(ot->entries(rank), entries_before);
+  ASSERT_EQ(ot->entries(rank) - entries_before - 1, ot->free_entries(rank));
+  ASSERT_TRUE(ot->verify());
+}
+
+
+TEST_F(MulticoreObjectTableTest, IsSparse) {
+  allocate_oops(8 * Multicore_Object_Table::entries_per_segment());
+  ASSERT_FALSE(ot->is_sparse(25));
+  free_oops(oops.size());
+  ASSERT_TRUE(ot->is_sparse(25));
+}
+
+
+/* An entry freed by one core goes on that core's free list, so the next core to use it may not be the one whose
+   segment it is in; the count of used entries stays with the segment either way. */
+TEST_F(MulticoreObjectTableTest, CountsEntriesByTheRankOfTheirSegment) {
+  Logical_Core::group_size = 2;
+  ot = new Multicore_Object_Table();
+  const int other = 1 - rank;
+
+  allocate_oops(1);
+  Oop x = ot->allocate_oop_and_set_backpointer(obj, other  COMMA_TRUE_OR_NOTHING);
+  ASSERT_EQ(1, ot->allocated_entries(rank));
+  ASSERT_EQ(1, ot->allocated_entries(other));
+
+  ot->free_oop(x  COMMA_TRUE_OR_NOTHING);
+  ASSERT_EQ(1, ot->allocated_entries(rank));
+  ASSERT_EQ(0, ot->allocated_entries(other));
+
+  allocate_oops(1); // the entry just freed
+  ASSERT_EQ(x, oops.back());
+  ASSERT_EQ(1, ot->allocated_entries(rank));
+  ASSERT_EQ(1, ot->allocated_entries(other));
+
+  free_oops(oops.size());
+  ASSERT_EQ(0, ot->allocated_entries(rank));
+  ASSERT_EQ(0, ot->allocated_entries(other));
+  ASSERT_TRUE(ot->verify());
+}
+
+
+/* The old oop still leads to the object, whose backpointer leads on to the new one,
+   which is how Memory_System::forward_all_references finds it. */
+TEST_F(MulticoreObjectTableTest, EmptyingMovesTheOopsOfTheSparsestSegments) {
+  std::vector<Object_p> survivors = leave_sparse_segments();
+  std::vector<Oop> old_oops;
+  for (size_t i = 0;  i < survivors.size();  ++i)
+    old_oops.push_back(survivors[i]->as_oop());
+
+  ASSERT_GT(ot->empty_sparsest_segments(), 0);
+
+  int moved = 0;
+  for (size_t i = 0;  i < survivors.size();  ++i) {
+    Oop new_oop = survivors[i]->as_oop();
+    ASSERT_EQ((Object*)survivors[i], ot->object_for(new_oop));
+    ASSERT_EQ((Object*)survivors[i], ot->object_for(old_oops[i]));
+    if (new_oop != old_oops[i])
+      ++moved;
+  }
+  ASSERT_GT(moved, 0);
+  ASSERT_EQ(0u, ot->spare_entries()); // the free lists are rebuilt from the kept segments
+  ASSERT_GE(ot->free_entries(rank), Multicore_Object_Table::free_entries_to_keep());
+
+  ot->release_emptied_segments();
+  free_survivors(survivors);
+  ASSERT_TRUE(ot->verify());
+}
+
+
+TEST_F(MulticoreObjectTableTest, ReleasedSegmentsAreReusedFirst) {
+  std::vector<Object_p> survivors = leave_sparse_segments();
+  int n = ot->empty_sparsest_segments();
+  ASSERT_GT(n, 0);
+  u_int32 entries_before = ot->entries(rank);
+  int reusable_before = ot->reusable_segments();
+
+  ot->release_emptied_segments();
+
+  ASSERT_EQ(entries_before - n * Multicore_Object_Table::entries_per_segment(), ot->entries(rank));
+  ASSERT_EQ(reusable_before + n, ot->reusable_segments());
+
+  drain_free_entries();
+  allocate_oops(1);
+  ASSERT_EQ(reusable_before + n - 1, ot->reusable_segments());
+  ASSERT_EQ(entries_before - (n - 1) * Multicore_Object_Table::entries_per_segment(), ot->entries(rank));
+
+  free_survivors(survivors);
+  ASSERT_TRUE(ot->verify());
+}
+
+# endif // !Omit_Object_Table
@@ -0,0 +1,205 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+# include <gtest/gtest.h>
+
+# include "headers.h"
+# include "test_memory_system.h"
+
+# if !Omit_Object_Table // nurseries need the object table
+
+class NurseryTest : public ::testing::Test {
+protected:
+  Nursery* nursery;
+
+  virtual void SetUp() {
+    Test_Memory_System::initialize();
+    nursery = The_Memory_System()->my_nursery();
+  }
+
+  Object* young(int slots = 1) { return Test_Memory_System::new_young_array(slots); }
+  Object* old  (int slots = 1) { return Test_Memory_System::new_old_array(slots); }
+};
+
+
+TEST_F(NurseryTest, NewObjectsArePrivate) {
+  ASSERT_TRUE(nursery != NULL);
+  Object* y = young();
+  Object* o = old();
+  ASSERT_TRUE(nursery->is_private(y));
+  ASSERT_FALSE(nursery->contains(o));
+}
+
+
+/* Only objects another core could store into need remembering. */
+TEST_F(NurseryTest, RemembersOnlyObjectsOutsideThePrivateNursery) {
+  Object* o = old();
+  Object* y = young();
+  nursery->remember((Object_p)o);
+  nursery->remember((Object_p)y);
+  ASSERT_TRUE (nursery->is_remembered(o->as_oop()));
+  ASSERT_FALSE(nursery->is_remembered(y->as_oop()));
+}
+
+
+TEST_F(NurseryTest, RememberedSetGrows) {
+  static const int n = 3000;
+  Oop oops[n];
+  for (int i = 0;  i < n;  ++i) {
+    Object* o = old();
+    nursery->remember((Object_p)o);
+    oops[i] = o->as_oop();
+  }
+  for (int i = 0;  i < n;  ++i)
+    ASSERT_TRUE(nursery->is_remembered(oops[i]));
+}
+
+
+TEST_F(NurseryTest, StoreIntoAPrivateObjectPublishesNothing) {
+  Object* y1 = young();
+  Object* y2 = young();
+  y1->storePointer(0, y2->as_oop());
+  ASSERT_TRUE(nursery->is_private(y1));
+  ASSERT_TRUE(nursery->is_private(y2));
+}
+
+
+/* Everything young the stored object reaches escapes with it, and nothing else. */
+TEST_F(NurseryTest, StoreIntoAnOldObjectPublishesWhatItReaches) {
+  Object* y1 = young(2);
+  Object* y2 = young();
+  Object* y3 = young();
+  Object* other = young();
+  y1->storePointer(0, y2->as_oop());
+  y1->storePointer(1, Oop::from_int(7));
+  y2->storePointer(0, y3->as_oop());
+  y3->storePointer(0, y1->as_oop()); // a cycle
+
+  old()->storePointer(0, y1->as_oop());
+
+  ASSERT_TRUE(nursery->is_escaped(y1));
+  ASSERT_TRUE(nursery->is_escaped(y2));
+  ASSERT_TRUE(nursery->is_escaped(y3));
+  ASSERT_TRUE(nursery->is_private(other));
+  // all of each object's words
+  ASSERT_TRUE(nursery->is_escaped(&((Oop*)y1->nextChunk())[-1]));
+}
+
+
+/* A remembered object may refer to private ones without a barrier, so publishing it publishes them. */
+TEST_F(NurseryTest, PublishingARememberedObjectForgetsIt) {
+  Object* o = old();
+  Object* y = young();
+  nursery->remember((Object_p)o);
+  o->storePointerIntoContext(0, y->as_oop()); // no barrier
+  ASSERT_TRUE(nursery->is_private(y));
+
+  nursery->publish(o->as_oop());
+
+  ASSERT_FALSE(nursery->is_remembered(o->as_oop()));
+  ASSERT_TRUE(nursery->is_escaped(y));
+}
+
+/* Without an image, the remembered set holds the only roots. The oops stay the same; only the objects move. */
+TEST_F(NurseryTest, ScavengePromotesWhatTheRememberedSetReaches) {
+  Object* o = old();
+  Object* y1 = young();
+  Object* y2 = young();
+  Object* garbage = young();
+  Oop y1_oop = y1->as_oop(),  y2_oop = y2->as_oop(),  garbage_oop = garbage->as_oop();
+  y1->storePointer(0, y2_oop);
+  o->storePointerIntoContext(0, y1_oop); // no barrier, so y1 stays private
+  nursery->remember((Object_p)o);
+
+  nursery->scavenge("test");
+
+  ASSERT_EQ(y1_oop, o->fetchPointer(0));
+  ASSERT_FALSE(nursery->contains(y1_oop.as_object()));
+  ASSERT_FALSE(nursery->contains(y2_oop.as_object()));
+  ASSERT_EQ(y2_oop, y1_oop.as_object()->fetchPointer(0));
+  ASSERT_TRUE(The_Memory_System()->object_table->is_OTE_free(garbage_oop));
+  ASSERT_FALSE(nursery->is_remembered(o->as_oop()));
+  ASSERT_TRUE(nursery->verify());
+}
+
+
+/* Other cores may hold their addresses, so escaped objects wait for the next full GC. */
+TEST_F(NurseryTest, EscapedObjectsStayInTheNursery) {
+  Object* y = young();
+  Oop y_oop = y->as_oop();
+  old()->storePointer(0, y_oop);
+  ASSERT_TRUE(nursery->is_escaped(y));
+
+  nursery->scavenge("test");
+
+  ASSERT_EQ(y, y_oop.as_object());
+  ASSERT_FALSE(The_Memory_System()->object_table->is_OTE_free(y_oop));
+  ASSERT_FALSE(nursery->is_empty());
+}
+
+
+TEST_F(NurseryTest, TenuringEmptiesTheNursery) {
+  Object* escaped = young();
+  Object* o = old();
+  o->storePointer(0, escaped->as_oop());
+  Object* y = young();
+  Oop escaped_oop = escaped->as_oop(),  y_oop = y->as_oop();
+  o->storePointerIntoContext(0, y_oop);
+  nursery->remember((Object_p)o);
+
+  Safepoint_Ability sa(true); // as the interpreter has, which takes the safepoint
+  ASSERT_TRUE(The_Memory_System()->tenure_all_nurseries("test"));
+
+  ASSERT_FALSE(nursery->contains(escaped_oop.as_object()));
+  ASSERT_FALSE(nursery->contains(y_oop.as_object()));
+  ASSERT_EQ(y_oop, o->fetchPointer(0));
+  ASSERT_FALSE(nursery->is_remembered(o->as_oop()));
+  ASSERT_TRUE(nursery->is_empty());
+}
+
+
+/* What the full GC marked moves out, unmarked; the rest is freed. */
+TEST_F(NurseryTest, FullGCSweepsAndTenures) {
+  Object* live = young();
+  Object* dead = young();
+  Oop live_oop = live->as_oop(),  dead_oop = dead->as_oop();
+  live->mark_without_store_barrier();
+
+  nursery->sweep_and_tenure_after_full_GC();
+
+  ASSERT_FALSE(nursery->contains(live_oop.as_object()));
+  ASSERT_FALSE(live_oop.as_object()->is_marked());
+  ASSERT_TRUE(The_Memory_System()->object_table->is_OTE_free(dead_oop));
+  ASSERT_TRUE(nursery->is_empty());
+}
+
+
+/* As when the object table is compacted: the old oop still leads to the object, whose backpointer has the new one. */
+TEST_F(NurseryTest, ForwardingRehashesTheRememberedSet) {
+  Object* o = old();
+  Object* other = old();
+  nursery->remember((Object_p)o);
+  nursery->remember((Object_p)other);
+  Oop old_oop = o->as_oop();
+  Oop new_oop = The_Memory_System()->object_table->allocate_oop_and_set_backpointer((Object_p)o, Logical_Core::my_rank()  COMMA_TRUE_OR_NOTHING);
+
+  nursery->forward_remembered_set();
+
+  ASSERT_TRUE (nursery->is_remembered(new_oop));
+  ASSERT_FALSE(nursery->is_remembered(old_oop));
+  ASSERT_TRUE (nursery->is_remembered(other->as_oop()));
+  The_Memory_System()->object_table->free_oop(old_oop  COMMA_TRUE_OR_NOTHING);
+}
+
+# endif // !Omit_Object_Table
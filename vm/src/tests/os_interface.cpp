@@ -45,6 +45,21 @@ TEST(OS_Interface, AtomicCompareAndSwap) {
 }
 
 
+/**
+ * Test the semantics of atomic_compare_and_swap on pointers
+ */
+TEST(OS_Interface, AtomicCompareAndSwapPointer) {
+  int a, b, c;
+  void* p = &a;
+  
+  ASSERT_FALSE(OS_Interface::atomic_compare_and_swap(&p, (void*)&b, (void*)&c));
+  ASSERT_EQ((void*)&a, p);  // Remains unchanged on failure
+  
+  ASSERT_TRUE(OS_Interface::atomic_compare_and_swap(&p, (void*)&a, (void*)&c));
+  ASSERT_EQ((void*)&c, p);  // Only changed when old_value == p
+}
+
+
 /**
  * Test the semantics of atomic_compare_and_swap_val
  */
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+# include <gtest/gtest.h>
+
+# include "headers.h"
+
+
+class SnapshotOutputTest : public ::testing::Test {
+protected:
+  FILE* file;
+
+  virtual void SetUp()    { file = tmpfile();  ASSERT_TRUE(file != NULL); }
+  virtual void TearDown() { fclose(file); }
+
+  static int32 word(int i) { return int32(0x5a000000 + i); }
+
+  off_t file_size() {
+    fflush(file);
+    return lseek(fileno(file), 0, SEEK_END);
+  }
+  int32 word_in_file(off_t pos) {
+    int32 w = 0;
+    EXPECT_EQ(ssize_t(sizeof(w)), pread(fileno(file), &w, sizeof(w), pos));
+    return w;
+  }
+};
+
+
+TEST_F(SnapshotOutputTest, BuffersTillFlushed) {
+  Snapshot_Output out(file);
+  for (int i = 0;  i < 100;  ++i)
+    out.put_long(word(i));
+  ASSERT_EQ(u_int64(100 * sizeof(int32)), out.bytes());
+  ASSERT_EQ(off_t(0), file_size());
+
+  out.flush();
+  ASSERT_EQ(off_t(100 * sizeof(int32)), file_size());
+  ASSERT_FALSE(out.has_failed());
+}
+
+
+/* Enough words to fill the buffer several times over; the last, partial buffer goes out when the output does. */
+TEST_F(SnapshotOutputTest, WritesManyBuffersInOrder) {
+  const int n = 100 * 1000 + 7;
+  {
+    Snapshot_Output out(file);
+    for (int i = 0;  i < n;  ++i)
+      out.put_long(word(i));
+    ASSERT_EQ(u_int64(n) * sizeof(int32), out.bytes());
+  }
+  ASSERT_EQ(off_t(n * sizeof(int32)), file_size());
+  for (int i = 0;  i < n;  i += 997)
+    ASSERT_EQ(word(i), word_in_file(i * sizeof(int32)));
+  ASSERT_EQ(word(n - 1), word_in_file((n - 1) * sizeof(int32)));
+}
+
+
+/* As when each core writes its own heaps: each output starts at its own offset, in whatever order they run. */
+TEST_F(SnapshotOutputTest, PwritesFromItsPosition) {
+  const int header_words = 16,  first_words = 50 * 1000,  second_words = 30 * 1000 + 3;
+  const off_t first_pos  = header_words * sizeof(int32);
+  const off_t second_pos = first_pos + first_words * sizeof(int32);
+  int fd = fileno(file);
+  {
+    Snapshot_Output second(fd, second_pos);
+    for (int i = 0;  i < second_words;  ++i)
+      second.put_long(word(first_words + i));
+  }
+  {
+    Snapshot_Output first(fd, first_pos);
+    for (int i = 0;  i < first_words;  ++i)
+      first.put_long(word(i));
+    ASSERT_EQ(u_int64(first_words) * sizeof(int32), first.bytes());
+  }
+  ASSERT_EQ(second_pos + off_t(second_words * sizeof(int32)), file_size());
+  ASSERT_EQ(int32(0), word_in_file(0)); // left for the header
+  for (int i = 0;  i < first_words + second_words;  i += 991)
+    ASSERT_EQ(word(i), word_in_file(first_pos + i * sizeof(int32)));
+  ASSERT_EQ(word(first_words - 1), word_in_file(second_pos - sizeof(int32)));
+  ASSERT_EQ(word(first_words),     word_in_file(second_pos));
+}
+
+
+TEST_F(SnapshotOutputTest, FailureSticks) {
+  char name[] = "/tmp/rvm-snapshot-output-XXXXXX";
+  int fd = mkstemp(name);
+  ASSERT_NE(-1, fd);
+  close(fd);
+  int read_only = open(name, O_RDONLY);
+  unlink(name);
+
+  Snapshot_Output out(read_only, 0);
+  out.put_long(word(0));
+  ASSERT_FALSE(out.has_failed()); // nothing written yet
+  out.flush();
+  ASSERT_TRUE(out.has_failed());
+  out.put_long(word(1));
+  out.flush();
+  ASSERT_TRUE(out.has_failed());
+  close(read_only);
+}
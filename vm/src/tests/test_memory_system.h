@@ -0,0 +1,78 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+/**
+ * Brings up the memory system of a single core, without an image,
+ * for the tests of the heaps and the object table.
+ *
+ * Without an image there are no classes, so the objects are made by hand:
+ * Arrays that only name a compact class, with SmallIntegers in their fields,
+ * which is all the heap code looks at.
+ */
+
+class Test_Memory_System {
+  static void helper_core_main() {}
+
+public:
+  static const int nursery_KB = 256;
+
+  static void initialize() {
+    static bool is_initialized = false;
+    if (is_initialized)
+      return;
+    is_initialized = true;
+
+    OS_Interface::initialize();
+    Memory_Semantics::initialize_timeout_timer();
+    Memory_Semantics::initialize_memory_system();
+    Printer::init_globals();
+
+    Logical_Core::num_cores = 1;
+    Memory_Semantics::go_parallel(helper_core_main, NULL);
+
+    Memory_System::min_heap_MB = 64;
+    if (!Omit_Object_Table)
+      Memory_System::nursery_KB = nursery_KB;
+    The_Memory_System()->initialize_from_snapshot(Mega, 0, 0, 0);
+  }
+
+  static oop_int_t bytes_for(int slots) {
+    return preheader_byte_size + (1 + slots) * bytesPerWord;
+  }
+
+  // slots must be below 63, to fit a short header
+  static Object_p new_array_in(Chunk* c, int slots) {
+    static const int compact_class_index_of_Array = 3;
+    oop_int_t* headerp = (oop_int_t*)((char*)c + preheader_byte_size);
+    headerp[0] =  (Object::Format::indexable_fields_only << Object::FormatShift)
+               |  (compact_class_index_of_Array << Object::CompactClassShift)
+               |  ((1 + slots) * bytesPerWord)
+               |  Header_Type::Short;
+    for (int i = 1;  i <= slots;  ++i)
+      headerp[i] = Oop::from_int(0).bits();
+
+    Object_p obj = (Object_p)(Object*)headerp;
+    The_Memory_System()->object_table->allocate_oop_and_set_preheader(obj, Logical_Core::my_rank()  COMMA_TRUE_OR_NOTHING);
+    return obj;
+  }
+
+  static Object_p new_old_array(int slots) {
+    Multicore_Object_Heap* h = The_Memory_System()->heaps[Logical_Core::my_rank()][Memory_System::read_write];
+    return new_array_in(h->allocateChunk(bytes_for(slots)), slots);
+  }
+
+  static Object_p new_young_array(int slots) {
+    return new_array_in(The_Memory_System()->my_nursery()->allocateChunk_for_a_new_object(bytes_for(slots)), slots);
+  }
+};
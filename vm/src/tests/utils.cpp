@@ -0,0 +1,51 @@
+/******************************************************************************
+ *  Copyright (c) 2008 - 2010 IBM Corporation and others.
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *    David Ungar, IBM Research - Initial Implementation
+ *    Sam Adams, IBM Research - Initial Implementation
+ *    Stefan Marr, Vrije Universiteit Brussel - Port to x86 Multi-Core Systems
+ ******************************************************************************/
+
+
+# include <gtest/gtest.h>
+
+# include "headers.h"
+
+
+static int32 word(int i) { return int32(0x01020304u + u_int32(i) * 0x01010101u); }
+
+/* Lengths around the 4 and 8 word steps, to cover the vector loops and the word-by-word tail. */
+TEST(ReverseBytes, MatchesSwappingEachWord) {
+  for (int n = 0;  n <= 21;  ++n) {
+    int32 words[21 + 1];
+    for (int i = 0;  i <= 21;  ++i)
+      words[i] = word(i);
+
+    reverseBytes(words, &words[n]);
+
+    for (int i = 0;  i < n;  ++i) {
+      int32 expected = word(i);
+      swap_bytes_long(&expected);
+      ASSERT_EQ(expected, words[i]);
+    }
+    ASSERT_EQ(word(21), words[21]); // past stop
+  }
+}
+
+TEST(ReverseBytes, Unaligned) {
+  int32 words[13];
+  for (int i = 0;  i < 13;  ++i)
+    words[i] = 0x11223344;
+
+  reverseBytes(&words[1], &words[12]);
+
+  ASSERT_EQ(int32(0x11223344), words[0]);
+  for (int i = 1;  i < 12;  ++i)
+    ASSERT_EQ(int32(0x44332211), words[i]);
+  ASSERT_EQ(int32(0x11223344), words[12]);
+}
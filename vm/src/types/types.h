@@ -14,12 +14,14 @@
 # ifndef __ROARVM_TYPES__
 # define __ROARVM_TYPES__
 
-typedef long int      int32;
+# include <stdint.h>
+
+typedef int32_t       int32;
 typedef long long int int64;
-typedef short int     int16;
+typedef int16_t       int16;
 
 typedef unsigned int           u_int1;   // used for 1-bit fields, Tilera compiler complains if its not unsigned
-typedef unsigned long int      u_int32;
+typedef uint32_t               u_int32;
 typedef unsigned long long int u_int64;
 
 typedef unsigned char u_char;
@@ -35,6 +37,11 @@ typedef void* (*fn_t)(...);
 class Object;
 class Chunk;
 class Abstract_Mark_Sweep_Collector;
+class Parallel_Mark_Work_Pool;
+class Parallel_Heap_Scan;
+class Snapshot_Output;
+class Nursery;
+class Abstract_Object_Heap;
 class Squeak_Image_Reader;
 class Squeak_Interpreter;
 
@@ -57,7 +64,7 @@ static const int BitsPerByte = 8;
 static const int BitsPerWord = sizeof(oop_int_t) * BitsPerByte;
 static const int BitsPerSmallInt = BitsPerWord - Tag_Size;
 
-static const int MinSmallInt = (1 << BitsPerSmallInt);
+static const int MinSmallInt = -(1 << (BitsPerSmallInt - 1));
 static const int MaxSmallInt = ~MinSmallInt;
 
 static const int Mega = 1024 * 1024;